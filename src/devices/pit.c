@@ -11,9 +11,6 @@
 #define PIT_PORT_CONTROL          0x43                /* Control port. */
 #define PIT_PORT_COUNTER(CHANNEL) (0x40 + (CHANNEL))  /* Counter port. */
 
-/* PIT cycles per second. */
-#define PIT_HZ 1193180
-
 /* Configure the given CHANNEL in the PIT.  In a PC, the PIT's
    three output channels are hooked up like this:
 
@@ -81,3 +78,44 @@ pit_configure_channel (int channel, int mode, int frequency)
   outb (PIT_PORT_COUNTER (channel), count >> 8);
   intr_set_level (old_level);
 }
+
+/* Starts CHANNEL counting down CYCLES PIT cycles, between 1 and
+   65536, in mode 0: its output goes high, raising one interrupt
+   on channel 0, when the count runs out, and stays high. */
+void
+pit_oneshot (int channel, unsigned cycles)
+{
+  enum intr_level old_level;
+
+  ASSERT (channel == 0 || channel == 2);
+  ASSERT (cycles >= 1 && cycles <= 65536);
+
+  /* A count of 0 stands for 65536. */
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, (channel << 6) | 0x30);
+  outb (PIT_PORT_COUNTER (channel), cycles);
+  outb (PIT_PORT_COUNTER (channel), cycles >> 8);
+  intr_set_level (old_level);
+}
+
+/* Returns the current count of CHANNEL and stores its output
+   level in *OUTPUT, using the read-back command to latch both
+   at the same instant. */
+uint16_t
+pit_read_channel (int channel, bool *output)
+{
+  uint8_t status, lo, hi;
+  enum intr_level old_level;
+
+  ASSERT (channel == 0 || channel == 2);
+
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, 0xc0 | (2 << channel));
+  status = inb (PIT_PORT_COUNTER (channel));
+  lo = inb (PIT_PORT_COUNTER (channel));
+  hi = inb (PIT_PORT_COUNTER (channel));
+  intr_set_level (old_level);
+
+  *output = (status & 0x80) != 0;
+  return lo | (hi << 8);
+}
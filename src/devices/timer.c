@@ -7,6 +7,9 @@
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#ifdef VM
+#include "vm/frame.h"
+#endif
   
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -20,6 +23,49 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* Kernel timers are kept in a hierarchical timer wheel of
+   WHEEL_LEVELS levels of WHEEL_SIZE slots.  A timer due within
+   WHEEL_SIZE ticks of wheel_clock sits in the level 0 slot for its
+   exact tick; one due later sits at the level whose slots span
+   WHEEL_SIZE^LEVEL ticks, and is moved down ("cascaded") when the
+   lower levels wrap around to its slot.  Adding or cancelling a
+   timer is O(1).
+
+   next_expiry caches the first tick at which a non-empty slot is
+   processed, so the interrupt handler does nothing until then, and
+   the wheel may skip straight to that tick since every slot in
+   between is empty.  It may be early, after a cancel, but never
+   late. */
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_SPAN ((int64_t) 1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+static struct list wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static uint64_t wheel_occupied[WHEEL_LEVELS]; /* Non-empty slots. */
+static int64_t wheel_clock;     /* Last tick the wheel processed. */
+static int64_t next_expiry = INT64_MAX;
+
+/* Dynamic ticks.  If true, the idle thread stops the periodic
+   interrupt until the next timer is due, up to the longest
+   one-shot the PIT's 16-bit counter can time, and the ticks that
+   went by are accounted for when it ends.  Controlled by kernel
+   command-line option "-tickless". */
+bool timer_tickless;
+
+/* PIT cycles per tick, and the most ticks one one-shot can span. */
+#define TICK_CYCLES ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+#define ONESHOT_MAX_TICKS (65536 / TICK_CYCLES)
+
+/* While a one-shot is armed, the PIT was started ONESHOT_PHASE
+   cycles after the last tick for ONESHOT_CYCLES cycles, ending on
+   a tick boundary ONESHOT_TICKS ticks after the last tick.
+   ONESHOT_TICKS is 0 while the timer is periodic. */
+static int oneshot_ticks;
+static unsigned oneshot_phase;
+static unsigned oneshot_cycles;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
@@ -29,12 +75,22 @@ static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
 static void real_time_delay (int64_t num, int32_t denom);
+static void wheel_insert (struct timer *);
+static void run_timers (void);
+static void timer_tick (void);
+static void oneshot_arm (unsigned phase, int ticks);
 
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
 void
 timer_init (void) 
 {
+  int level, slot;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    for (slot = 0; slot < WHEEL_SIZE; slot++)
+      list_init (&wheel[level][slot]);
+
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
@@ -177,6 +233,105 @@ timer_print_stats (void)
 /* Timer interrupt handler. */
 static void
 timer_interrupt (struct intr_frame *args UNUSED)
+{
+  bool expired;
+
+  if (oneshot_ticks > 0 && (pit_read_channel (0, &expired), expired))
+    {
+      /* A one-shot ran out: go back to periodic mode and account
+         for all the ticks it covered.  (Otherwise this is the last
+         periodic tick, already pending when the one-shot was armed,
+         and the one-shot counts from it.) */
+      int n = oneshot_ticks;
+
+      oneshot_ticks = 0;
+      pit_configure_channel (0, 2, TIMER_FREQ);
+      while (n-- > 0)
+        timer_tick ();
+    }
+  else
+    timer_tick ();
+}
+
+/* Called by the idle thread, with interrupts off, just before it
+   halts.  In tickless mode, replaces the periodic interrupt by a
+   single one at the tick the next timer is due. */
+void
+timer_idle_enter (void) 
+{
+  int64_t idle_ticks;
+  uint16_t count;
+  bool output;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!timer_tickless || oneshot_ticks > 0)
+    return;
+  idle_ticks = next_expiry - ticks;
+  if (idle_ticks <= 1)
+    return;
+  if (idle_ticks > ONESHOT_MAX_TICKS)
+    idle_ticks = ONESHOT_MAX_TICKS;
+
+  /* Start counting from where the current period has got to, so
+     that the one-shot ends on a tick boundary. */
+  count = pit_read_channel (0, &output);
+  if (count == 0 || count > TICK_CYCLES)
+    count = TICK_CYCLES;
+  oneshot_arm (TICK_CYCLES - count, idle_ticks);
+}
+
+/* Called on every external interrupt other than the timer's.  If
+   it woke the CPU from tickless idle, accounts for the ticks that
+   went by and rearms the PIT for the next tick boundary, so that
+   whatever runs next has a running clock. */
+void
+timer_idle_exit (void) 
+{
+  unsigned elapsed;
+  uint16_t count;
+  bool expired;
+  int n;
+
+  ASSERT (intr_context ());
+
+  if (oneshot_ticks == 0)
+    return;
+  count = pit_read_channel (0, &expired);
+  if (expired)
+    {
+      /* The timer interrupt is pending and will do the work. */
+      return;
+    }
+
+  elapsed = oneshot_phase + oneshot_cycles - (count == 0 ? 65536 : count);
+  n = elapsed / TICK_CYCLES;
+  if (n == 0 && oneshot_ticks == 1)
+    return;
+
+  oneshot_arm (elapsed % TICK_CYCLES, 1);
+  while (n-- > 0)
+    timer_tick ();
+}
+
+/* Arms a one-shot that starts PHASE cycles after a tick and ends
+   TICKS ticks after it. */
+static void
+oneshot_arm (unsigned phase, int ticks) 
+{
+  ASSERT (phase < TICK_CYCLES);
+  ASSERT (ticks >= 1 && ticks <= ONESHOT_MAX_TICKS);
+
+  oneshot_phase = phase;
+  oneshot_cycles = ticks * TICK_CYCLES - phase;
+  oneshot_ticks = ticks;
+  pit_oneshot (0, oneshot_cycles);
+}
+
+/* Advances the clock by one tick and does the periodic work that
+   goes with it. */
+static void
+timer_tick (void) 
 {
   ticks++;
   thread_tick ();
@@ -185,14 +340,212 @@ timer_interrupt (struct intr_frame *args UNUSED)
     increment_recent_cpu_on_every_tick ();
     if (ticks % TIMER_FREQ == 0) {
       update_load_avg();
-      mlfqs_set_recent_cpu_of_all_thread ();
+      mlfqs_set_recent_cpu_of_ready_threads ();
     }
     if (ticks % 4 == 0) {
-      mlfqs_set_priority_of_all_thread ();
+      mlfqs_set_priority_of_current_thread ();
     }
   }
 
-  thread_wakeup(ticks);
+  if (ticks >= next_expiry)
+    run_timers ();
+
+#ifdef VM
+  if (ticks % PFF_INTERVAL == 0) {
+    frame_pff_update ();
+  }
+#endif
+}
+
+/* Initializes timer T to call FUNC(AUX) when it fires. */
+void
+timer_setup (struct timer *t, timer_func *func, void *aux) 
+{
+  t->func = func;
+  t->aux = aux;
+  t->level = -1;
+}
+
+/* Arms timer T, which must not be pending, to fire once
+   timer_ticks() reaches EXPIRES.  A timer whose EXPIRES has
+   already passed fires on the next tick. */
+void
+timer_add (struct timer *t, int64_t expires) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  ASSERT (t->level < 0);
+
+  /* Every tick since wheel_clock found its slots empty, so the
+     wheel may be brought up to date before placing T. */
+  if (next_expiry > ticks)
+    wheel_clock = ticks;
+  t->expires = expires;
+  wheel_insert (t);
+  intr_set_level (old_level);
+}
+
+/* Disarms timer T.  Returns true if it was pending, false if it
+   had already fired or was never added. */
+bool
+timer_cancel (struct timer *t) 
+{
+  enum intr_level old_level = intr_disable ();
+  bool pending = t->level >= 0;
+
+  if (pending)
+    {
+      list_remove (&t->elem);
+      if (list_empty (&wheel[t->level][t->slot]))
+        wheel_occupied[t->level] &= ~((uint64_t) 1 << t->slot);
+      t->level = -1;
+    }
+  intr_set_level (old_level);
+  return pending;
+}
+
+/* Returns true if timer T is armed and has not fired yet. */
+bool
+timer_pending (const struct timer *t) 
+{
+  return t->level >= 0;
+}
+
+/* Returns the index of the lowest set bit in X, which must not
+   be zero. */
+static int
+lowest_bit (uint64_t x) 
+{
+  uint32_t lo = x;
+
+  return lo != 0 ? __builtin_ctz (lo) : 32 + __builtin_ctz (x >> 32);
+}
+
+/* Returns the first tick after wheel_clock at which SLOT of LEVEL
+   is processed: a level 0 slot when its tick comes, a higher one
+   when the level below wraps around to it. */
+static int64_t
+slot_time (int level, int slot) 
+{
+  int shift = level * WHEEL_BITS;
+  int64_t base = wheel_clock >> shift;
+
+  return (base + ((slot - base - 1) & WHEEL_MASK) + 1) << shift;
+}
+
+/* Puts T into the wheel slot for T->expires, relative to
+   wheel_clock. */
+static void
+wheel_insert (struct timer *t) 
+{
+  int64_t expires = t->expires > wheel_clock ? t->expires : wheel_clock + 1;
+  int64_t delta = expires - wheel_clock;
+  int64_t when;
+  int level;
+
+  if (delta >= WHEEL_SPAN)
+    {
+      /* Park it in the farthest slot; it is placed again when
+         that slot cascades. */
+      expires = wheel_clock + WHEEL_SPAN - 1;
+      delta = WHEEL_SPAN - 1;
+    }
+  for (level = 0; delta >> (WHEEL_BITS * (level + 1)) != 0; level++)
+    continue;
+
+  t->level = level;
+  t->slot = (expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+  list_push_back (&wheel[level][t->slot], &t->elem);
+  wheel_occupied[level] |= (uint64_t) 1 << t->slot;
+
+  when = slot_time (level, t->slot);
+  if (when < next_expiry)
+    next_expiry = when;
+}
+
+/* Removes and returns the list of timers in SLOT of LEVEL. */
+static void
+wheel_take (int level, int slot, struct list *out) 
+{
+  struct list *l = &wheel[level][slot];
+
+  list_init (out);
+  if (!list_empty (l))
+    list_splice (list_end (out), list_begin (l), list_end (l));
+  wheel_occupied[level] &= ~((uint64_t) 1 << slot);
+}
+
+/* Recomputes next_expiry from the occupied slots. */
+static void
+update_next_expiry (void) 
+{
+  int level;
+
+  next_expiry = INT64_MAX;
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      int shift = level * WHEEL_BITS;
+      int start = ((wheel_clock >> shift) + 1) & WHEEL_MASK;
+      uint64_t occupied = wheel_occupied[level];
+      int64_t when;
+
+      if (occupied == 0)
+        continue;
+
+      /* Rotate so that bit 0 is the next slot to be processed. */
+      if (start != 0)
+        occupied = (occupied >> start) | (occupied << (WHEEL_SIZE - start));
+      when = slot_time (level, (start + lowest_bit (occupied)) & WHEEL_MASK);
+      if (when < next_expiry)
+        next_expiry = when;
+    }
+}
+
+/* Processes the wheel up to the current tick, cascading timers
+   to lower levels and running the callbacks of expired ones.
+   Runs in the timer interrupt. */
+static void
+run_timers (void) 
+{
+  while (next_expiry <= ticks)
+    {
+      struct list due;
+      int level;
+
+      wheel_clock = next_expiry;
+      wheel_take (0, wheel_clock & WHEEL_MASK, &due);
+      for (level = 1; level < WHEEL_LEVELS; level++)
+        {
+          int shift = level * WHEEL_BITS;
+          struct list cascade;
+
+          if ((wheel_clock & (((int64_t) 1 << shift) - 1)) != 0)
+            break;
+          wheel_take (level, (wheel_clock >> shift) & WHEEL_MASK, &cascade);
+          while (!list_empty (&cascade))
+            {
+              struct timer *t = list_entry (list_pop_front (&cascade),
+                                            struct timer, elem);
+
+              /* A timer that expires on this very tick, such as one
+                 for a multiple of 64, is due now; wheel_insert()
+                 would put it off to the next tick. */
+              if (t->expires <= wheel_clock)
+                list_push_back (&due, &t->elem);
+              else
+                wheel_insert (t);
+            }
+        }
+
+      while (!list_empty (&due))
+        {
+          struct timer *t = list_entry (list_pop_front (&due),
+                                        struct timer, elem);
+          t->level = -1;
+          t->func (t->aux);
+        }
+      update_next_expiry ();
+    }
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
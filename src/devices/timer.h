@@ -1,7 +1,9 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
@@ -26,4 +28,28 @@ void timer_ndelay (int64_t nanoseconds);
 
 void timer_print_stats (void);
 
+/* Dynamic ticks. */
+extern bool timer_tickless;
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+
+/* Kernel timers.  Once timer_ticks() reaches EXPIRES, FUNC(AUX) is
+   called from the timer interrupt handler, so it must not sleep. */
+typedef void timer_func (void *aux);
+
+struct timer
+  {
+    int64_t expires;                    /* Tick to fire at. */
+    timer_func *func;                   /* Callback. */
+    void *aux;                          /* Argument to FUNC. */
+    struct list_elem elem;              /* Element in a wheel slot. */
+    int level;                          /* Wheel level, -1 if idle. */
+    int slot;                           /* Slot within LEVEL. */
+  };
+
+void timer_setup (struct timer *, timer_func *, void *aux);
+void timer_add (struct timer *, int64_t expires);
+bool timer_cancel (struct timer *);
+bool timer_pending (const struct timer *);
+
 #endif /* devices/timer.h */
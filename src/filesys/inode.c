@@ -6,6 +6,11 @@
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#ifdef VM
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "vm/frame.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -36,6 +41,7 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    int cached_pages;                   /* Pages in the VM page cache. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -136,6 +142,7 @@ inode_open (block_sector_t sector)
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
+  inode->cached_pages = 0;
   inode->removed = false;
   block_read (fs_device, inode->sector, &inode->data);
   return inode;
@@ -194,6 +201,37 @@ inode_remove (struct inode *inode)
   inode->removed = true;
 }
 
+#ifdef VM
+/* Notes that DELTA more pages of INODE are in the VM page cache.
+   The frame table lock must be held. */
+void
+inode_add_cached_pages (struct inode *inode, int delta)
+{
+  inode->cached_pages += delta;
+  ASSERT (inode->cached_pages >= 0);
+}
+
+/* Returns true if some page of INODE is in the VM page cache.
+   Pages enter the cache only under the file system lock, so a
+   caller holding it may rely on a false result. */
+bool
+inode_has_cached_pages (const struct inode *inode)
+{
+  return inode->cached_pages > 0;
+}
+
+/* Returns how many of the SIZE bytes starting at OFFSET lie both
+   in INODE and in OFFSET's page. */
+static off_t
+page_span (const struct inode *inode, off_t offset, off_t size)
+{
+  off_t inode_left = inode_length (inode) - offset;
+  off_t page_left = PGSIZE - offset % PGSIZE;
+  off_t span = size < inode_left ? size : inode_left;
+  return span < page_left ? span : page_left;
+}
+#endif
+
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
    Returns the number of bytes actually read, which may be less
    than SIZE if an error occurs or end of file is reached. */
@@ -203,6 +241,10 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
   uint8_t *buffer = buffer_;
   off_t bytes_read = 0;
   uint8_t *bounce = NULL;
+#ifdef VM
+  uint8_t *page = NULL;
+  bool page_cached = false;
+#endif
 
   while (size > 0) 
     {
@@ -220,6 +262,33 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       if (chunk_size <= 0)
         break;
 
+#ifdef VM
+      /* A page of the file that is in memory, possibly mapped and
+         modified by some process, is newer than the disk copy.  At
+         the start of each page, copy all we want of it out of the
+         page cache into PAGE: touching the caller's buffer may
+         fault, which must not happen while the frame table is
+         locked. */
+      if (bytes_read == 0 || offset % PGSIZE == 0)
+        {
+          page_cached = false;
+          if (inode_has_cached_pages (inode))
+            {
+              if (page == NULL)
+                {
+                  page = palloc_get_page (0);
+                  if (page == NULL)
+                    break;
+                }
+              page_cached = page_cache_read (inode, offset,
+                                             page + offset % PGSIZE,
+                                             page_span (inode, offset, size));
+            }
+        }
+      if (page_cached)
+        memcpy (buffer + bytes_read, page + offset % PGSIZE, chunk_size);
+      else
+#endif
       if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
         {
           /* Read full sector directly into caller's buffer. */
@@ -245,6 +314,9 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       bytes_read += chunk_size;
     }
   free (bounce);
+#ifdef VM
+  palloc_free_page (page);
+#endif
 
   return bytes_read;
 }
@@ -261,6 +333,10 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   const uint8_t *buffer = buffer_;
   off_t bytes_written = 0;
   uint8_t *bounce = NULL;
+#ifdef VM
+  uint8_t *page = NULL;
+  bool page_cached = false;
+#endif
 
   if (inode->deny_write_cnt)
     return 0;
@@ -270,6 +346,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       /* Sector to write, starting byte offset within sector. */
       block_sector_t sector_idx = byte_to_sector (inode, offset);
       int sector_ofs = offset % BLOCK_SECTOR_SIZE;
+      const uint8_t *src = buffer + bytes_written;
 
       /* Bytes left in inode, bytes left in sector, lesser of the two. */
       off_t inode_left = inode_length (inode) - offset;
@@ -281,10 +358,39 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       if (chunk_size <= 0)
         break;
 
+#ifdef VM
+      /* Keep mapped copies of the page in step with the disk.  At
+         the start of each page whose file has pages in the page
+         cache, copy all we write to it into PAGE, outside the frame
+         table lock, update the cached page from there, and write
+         the disk from there too. */
+      if (bytes_written == 0 || offset % PGSIZE == 0)
+        {
+          page_cached = false;
+          if (inode_has_cached_pages (inode))
+            {
+              off_t page_size = page_span (inode, offset, size);
+
+              if (page == NULL)
+                {
+                  page = palloc_get_page (0);
+                  if (page == NULL)
+                    break;
+                }
+              memcpy (page + offset % PGSIZE, src, page_size);
+              page_cache_write (inode, offset, page + offset % PGSIZE,
+                                page_size);
+              page_cached = true;
+            }
+        }
+      if (page_cached)
+        src = page + offset % PGSIZE;
+#endif
+
       if (sector_ofs == 0 && chunk_size == BLOCK_SECTOR_SIZE)
         {
           /* Write full sector directly to disk. */
-          block_write (fs_device, sector_idx, buffer + bytes_written);
+          block_write (fs_device, sector_idx, src);
         }
       else 
         {
@@ -303,7 +409,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
             block_read (fs_device, sector_idx, bounce);
           else
             memset (bounce, 0, BLOCK_SECTOR_SIZE);
-          memcpy (bounce + sector_ofs, buffer + bytes_written, chunk_size);
+          memcpy (bounce + sector_ofs, src, chunk_size);
           block_write (fs_device, sector_idx, bounce);
         }
 
@@ -313,6 +419,9 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       bytes_written += chunk_size;
     }
   free (bounce);
+#ifdef VM
+  palloc_free_page (page);
+#endif
 
   return bytes_written;
 }
@@ -19,5 +19,9 @@ off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
+#ifdef VM
+void inode_add_cached_pages (struct inode *, int delta);
+bool inode_has_cached_pages (const struct inode *);
+#endif
 
 #endif /* filesys/inode.h */
@@ -28,7 +28,23 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_FORK,                   /* Clone this process. */
+    SYS_MMAP_ANON,              /* Map anonymous memory. */
+    SYS_SBRK,                   /* Move the end of the heap. */
+    SYS_MADVISE                 /* Give advice about memory use. */
+  };
+
+/* Advice for SYS_MADVISE. */
+enum
+  {
+    MADV_NORMAL,                /* No particular access pattern. */
+    MADV_SEQUENTIAL,            /* Read ahead aggressively, drop behind. */
+    MADV_RANDOM,                /* Do not read ahead. */
+    MADV_WILLNEED,              /* Bring the pages in now. */
+    MADV_DONTNEED               /* Discard the pages. */
   };
 
 #endif /* lib/syscall-nr.h */
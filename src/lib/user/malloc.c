@@ -0,0 +1,184 @@
+#include <malloc.h>
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+
+/* A simple first-fit allocator on top of sbrk().
+
+   Every block, free or in use, starts with a header that gives its
+   size in header-sized units, header included.  Free blocks are
+   kept on a circular list sorted by address, so that free() can
+   merge a block with its free neighbours.  When no free block is
+   big enough, the heap is grown by at least MIN_GROW bytes and the
+   new memory is added to the free list. */
+
+/* Block header.  Its size is also the allocation granularity, and
+   it keeps returned blocks 8-byte aligned. */
+struct header
+  {
+    struct header *next;        /* Next free block, if free. */
+    size_t units;               /* Size in units, header included. */
+  };
+
+/* Grow the heap by at least this many bytes at a time. */
+#define MIN_GROW (16 * 1024)
+
+static struct header base;      /* Empty block to start the list. */
+static struct header *free_list; /* Where the last search ended. */
+
+static struct header *grow_heap (size_t units);
+
+/* Obtains and returns a new block of at least SIZE bytes.
+   Returns a null pointer if memory is not available. */
+void *
+malloc (size_t size) 
+{
+  struct header *prev, *b;
+  size_t units;
+
+  if (size == 0)
+    return NULL;
+  units = DIV_ROUND_UP (size, sizeof (struct header)) + 1;
+
+  if (free_list == NULL)
+    {
+      base.next = free_list = &base;
+      base.units = 0;
+    }
+
+  prev = free_list;
+  for (b = prev->next; ; prev = b, b = b->next)
+    {
+      if (b->units >= units)
+        {
+          if (b->units == units)
+            prev->next = b->next;
+          else
+            {
+              /* Hand out the tail end of the block. */
+              b->units -= units;
+              b += b->units;
+              b->units = units;
+            }
+          free_list = prev;
+          return b + 1;
+        }
+      if (b == free_list)
+        {
+          /* Wrapped around: nothing fits. */
+          b = grow_heap (units);
+          if (b == NULL)
+            return NULL;
+        }
+    }
+}
+
+/* Allocates and return A times B bytes initialized to zeroes.
+   Returns a null pointer if memory is not available. */
+void *
+calloc (size_t a, size_t b) 
+{
+  void *p;
+  size_t size;
+
+  /* Calculate block size and make sure it fits in size_t. */
+  size = a * b;
+  if (size < a || size < b)
+    return NULL;
+
+  p = malloc (size);
+  if (p != NULL)
+    memset (p, 0, size);
+  return p;
+}
+
+/* Attempts to resize OLD_BLOCK to NEW_SIZE bytes, possibly moving
+   it in the process.
+   If successful, returns the new block; on failure, returns a
+   null pointer.
+   A call with null OLD_BLOCK is equivalent to malloc(new_size).
+   A call with zero NEW_SIZE is equivalent to free(old_block). */
+void *
+realloc (void *old_block, size_t new_size) 
+{
+  if (new_size == 0) 
+    {
+      free (old_block);
+      return NULL;
+    }
+  else 
+    {
+      void *new_block = malloc (new_size);
+      if (old_block != NULL && new_block != NULL)
+        {
+          struct header *h = (struct header *) old_block - 1;
+          size_t old_size = (h->units - 1) * sizeof (struct header);
+          size_t size = new_size < old_size ? new_size : old_size;
+          memcpy (new_block, old_block, size);
+          free (old_block);
+        }
+      return new_block;
+    }
+}
+
+/* Frees block P, which must have been previously allocated with
+   malloc(), calloc(), or realloc(). */
+void
+free (void *p) 
+{
+  struct header *h, *b;
+
+  if (p == NULL)
+    return;
+  h = (struct header *) p - 1;
+
+  /* Find the free blocks on either side of H. */
+  for (b = free_list; !(h > b && h < b->next); b = b->next)
+    if (b >= b->next && (h > b || h < b->next))
+      break;                    /* H is at one end of the heap. */
+
+  /* Merge with the following block. */
+  if (h + h->units == b->next)
+    {
+      h->units += b->next->units;
+      h->next = b->next->next;
+    }
+  else
+    h->next = b->next;
+
+  /* Merge with the preceding block. */
+  if (b + b->units == h)
+    {
+      b->units += h->units;
+      b->next = h->next;
+    }
+  else
+    b->next = h;
+
+  free_list = b;
+}
+
+/* Grows the heap by enough for a block of UNITS units and puts the
+   new memory on the free list.  Returns the free list position to
+   continue searching from, or a null pointer if the kernel refused
+   to grow the heap. */
+static struct header *
+grow_heap (size_t units) 
+{
+  size_t size = ROUND_UP (units * sizeof (struct header), MIN_GROW);
+  uint8_t *brk = sbrk (0);
+  struct header *h;
+
+  /* Keep blocks aligned even if someone else moved the break. */
+  size_t pad = ROUND_UP ((uintptr_t) brk, sizeof (struct header))
+               - (uintptr_t) brk;
+
+  if (sbrk (size + pad) == (void *) -1)
+    return NULL;
+  h = (struct header *) (brk + pad);
+  h->units = size / sizeof (struct header);
+  free (h + 1);
+  return free_list;
+}
@@ -0,0 +1,67 @@
+/* Arms kernel timers with callbacks at deadlines both near and
+   far enough to be cascaded down the timer wheel, cancels one of
+   them, and verifies that the rest fire in deadline order and no
+   earlier than their deadlines. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define TIMER_CNT 4
+
+static struct semaphore fired;
+static int order[TIMER_CNT];
+static int order_cnt;
+static int64_t fire_ticks[TIMER_CNT];
+
+static void
+callback (void *aux) 
+{
+  int i = (int) aux;
+
+  fire_ticks[i] = timer_ticks ();
+  order[order_cnt++] = i;
+  sema_up (&fired);
+}
+
+void
+test_alarm_callback (void) 
+{
+  /* Deadlines in ticks from now, in the order they should fire.
+     The last one is cancelled. */
+  static const int64_t delays[TIMER_CNT] = {3, 70, 300, 50};
+  struct timer timers[TIMER_CNT];
+  int64_t start;
+  int i;
+
+  sema_init (&fired, 0);
+  start = timer_ticks ();
+  for (i = TIMER_CNT - 1; i >= 0; i--)
+    {
+      timer_setup (&timers[i], callback, (void *) i);
+      timer_add (&timers[i], start + delays[i]);
+    }
+  if (!timer_cancel (&timers[TIMER_CNT - 1]))
+    fail ("pending timer could not be cancelled");
+
+  for (i = 0; i < TIMER_CNT - 1; i++)
+    sema_down (&fired);
+
+  for (i = 0; i < TIMER_CNT - 1; i++)
+    {
+      if (order[i] != i)
+        fail ("timer %d fired in position %d", order[i], i);
+      if (fire_ticks[i] < start + delays[i])
+        fail ("timer %d fired %lld ticks early",
+              i, start + delays[i] - fire_ticks[i]);
+      if (timer_pending (&timers[i]))
+        fail ("timer %d still pending after firing", i);
+    }
+  if (timer_cancel (&timers[TIMER_CNT - 1]))
+    fail ("cancelled timer was still pending");
+  msg ("%d timers fired in order", order_cnt);
+  pass ();
+}
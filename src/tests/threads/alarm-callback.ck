@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-callback) begin
+(alarm-callback) 3 timers fired in order
+(alarm-callback) PASS
+(alarm-callback) end
+EOF
+pass;
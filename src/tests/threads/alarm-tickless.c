@@ -0,0 +1,108 @@
+/* Run with -tickless.  Two threads sleep to interleaved deadlines
+   while kernel timers are due in between, and the CPU is otherwise
+   idle, so that the periodic tick is stopped between deadlines for
+   anything from one tick to more than a one-shot can cover.
+   Verifies that every timer fires on exactly its deadline tick,
+   that every sleeper wakes on or just after its deadline, and that
+   the clock has caught up with all the ticks that went by. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SLEEP_CNT 6
+
+/* Sleepers' deadlines, in ticks after the base. */
+static const int64_t sleeps[2][SLEEP_CNT] =
+  {
+    {1, 3, 8, 20, 57, 300},
+    {2, 4, 5, 21, 56, 301},
+  };
+
+/* Timers' deadlines, in ticks after the base. */
+static const int64_t offsets[] = {2, 6, 7, 13, 64, 333};
+#define TIMER_CNT (sizeof offsets / sizeof *offsets)
+
+/* Main thread's deadline, after all the others. */
+#define MAIN_OFFSET 400
+
+static struct semaphore fired;
+static struct semaphore done;
+static int64_t base;
+static int64_t fire_ticks[TIMER_CNT];
+static int64_t wake_ticks[2][SLEEP_CNT];
+
+static thread_func sleeper;
+
+static void
+callback (void *aux) 
+{
+  int i = (int) aux;
+
+  fire_ticks[i] = timer_ticks ();
+  sema_up (&fired);
+}
+
+void
+test_alarm_tickless (void) 
+{
+  struct timer timers[TIMER_CNT];
+  int64_t woke;
+  size_t i, j;
+
+  ASSERT (timer_tickless);
+
+  sema_init (&fired, 0);
+  sema_init (&done, 0);
+
+  base = timer_ticks () + 10;
+  for (i = 0; i < TIMER_CNT; i++)
+    {
+      timer_setup (&timers[i], callback, (void *) i);
+      timer_add (&timers[i], base + offsets[i]);
+    }
+  thread_create ("sleeper 0", PRI_DEFAULT, sleeper, (void *) 0);
+  thread_create ("sleeper 1", PRI_DEFAULT, sleeper, (void *) 1);
+
+  thread_sleep (base + MAIN_OFFSET);
+  woke = timer_ticks () - base;
+  if (woke < MAIN_OFFSET || woke > MAIN_OFFSET + 1)
+    fail ("main thread woke at base + %lld, expected base + %d",
+          woke, MAIN_OFFSET);
+
+  for (i = 0; i < 2; i++)
+    sema_down (&done);
+  for (i = 0; i < 2; i++)
+    for (j = 0; j < SLEEP_CNT; j++)
+      if (wake_ticks[i][j] < sleeps[i][j]
+          || wake_ticks[i][j] > sleeps[i][j] + 1)
+        fail ("sleeper %d woke at base + %lld, expected base + %lld",
+              (int) i, wake_ticks[i][j], sleeps[i][j]);
+  msg ("%d sleeps woke on time", 2 * SLEEP_CNT);
+
+  for (i = 0; i < TIMER_CNT; i++)
+    sema_down (&fired);
+  for (i = 0; i < TIMER_CNT; i++)
+    if (fire_ticks[i] != base + offsets[i])
+      fail ("timer for base + %lld fired at base + %lld",
+            offsets[i], fire_ticks[i] - base);
+  msg ("%d timers fired on time", (int) TIMER_CNT);
+  pass ();
+}
+
+static void
+sleeper (void *aux) 
+{
+  int id = (int) aux;
+  int i;
+
+  for (i = 0; i < SLEEP_CNT; i++)
+    {
+      thread_sleep (base + sleeps[id][i]);
+      wake_ticks[id][i] = timer_ticks () - base;
+    }
+  sema_up (&done);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-tickless) begin
+(alarm-tickless) 12 sleeps woke on time
+(alarm-tickless) 6 timers fired on time
+(alarm-tickless) PASS
+(alarm-tickless) end
+EOF
+pass;
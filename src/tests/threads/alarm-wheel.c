@@ -0,0 +1,65 @@
+/* Arms kernel timers whose deadlines sit on and next to the
+   boundaries between timer wheel levels, including multiples of
+   64 ticks that are reached by cascading from a higher level, and
+   sleeps until one of them.  Verifies that each timer fires, and
+   the sleeper wakes, on exactly its deadline tick. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Deadlines in ticks after a multiple of 64. */
+static const int64_t offsets[] = {64, 65, 127, 128, 192, 640, 4032, 4096,
+                                  4160};
+#define TIMER_CNT (sizeof offsets / sizeof *offsets)
+
+/* Sleeper's deadline, also after the same multiple of 64. */
+#define SLEEP_OFFSET 4096
+
+static struct semaphore fired;
+static int64_t fire_ticks[TIMER_CNT];
+
+static void
+callback (void *aux) 
+{
+  int i = (int) aux;
+
+  fire_ticks[i] = timer_ticks ();
+  sema_up (&fired);
+}
+
+void
+test_alarm_wheel (void) 
+{
+  struct timer timers[TIMER_CNT];
+  int64_t base;
+  size_t i;
+
+  sema_init (&fired, 0);
+
+  /* Line the deadlines up with the level 1 slots, so that most of
+     them are multiples of 64 ticks. */
+  base = (timer_ticks () / 64 + 1) * 64;
+  for (i = 0; i < TIMER_CNT; i++)
+    {
+      timer_setup (&timers[i], callback, (void *) i);
+      timer_add (&timers[i], base + offsets[i]);
+    }
+
+  thread_sleep (base + SLEEP_OFFSET);
+  if (timer_ticks () != base + SLEEP_OFFSET)
+    fail ("sleeper woke at base + %lld, expected base + %d",
+          timer_ticks () - base, SLEEP_OFFSET);
+
+  for (i = 0; i < TIMER_CNT; i++)
+    sema_down (&fired);
+  for (i = 0; i < TIMER_CNT; i++)
+    if (fire_ticks[i] != base + offsets[i])
+      fail ("timer for base + %lld fired at base + %lld",
+            offsets[i], fire_ticks[i] - base);
+  msg ("%d timers fired on time", (int) TIMER_CNT);
+  pass ();
+}
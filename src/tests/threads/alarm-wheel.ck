@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-wheel) begin
+(alarm-wheel) 9 timers fired on time
+(alarm-wheel) PASS
+(alarm-wheel) end
+EOF
+pass;
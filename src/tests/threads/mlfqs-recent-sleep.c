@@ -0,0 +1,47 @@
+/* Checks that a thread's recent_cpu keeps decaying while it
+   sleeps.  The main thread runs until its recent_cpu is well
+   above 20, sets its nice value to 5, and sleeps, first for less
+   and then for more seconds than the scheduler remembers decay
+   factors for.  With the system otherwise idle, load_avg is near
+   0, so each second's decay brings recent_cpu close to nice; a
+   thread that was not caught up on waking would still have a
+   recent_cpu above 20, and one whose nice value was dropped would
+   have one near 0. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static void sleep_and_check (int seconds);
+
+void
+test_mlfqs_recent_sleep (void)
+{
+  ASSERT (thread_mlfqs);
+
+  while (thread_get_recent_cpu () < 5000)
+    continue;
+  thread_set_nice (5);
+
+  sleep_and_check (10);
+  sleep_and_check (70);
+  pass ();
+}
+
+/* Sleeps SECONDS seconds, then checks that recent_cpu is about 5,
+   allowing for the ticks it takes to get back here. */
+static void
+sleep_and_check (int seconds)
+{
+  int recent_cpu;
+
+  msg ("Sleeping %d seconds, please wait...", seconds);
+  timer_sleep (seconds * TIMER_FREQ);
+  recent_cpu = thread_get_recent_cpu ();
+  if (recent_cpu < 500 || recent_cpu >= 700)
+    fail ("After %d seconds asleep, recent_cpu is %d.%02d, not about 5.",
+          seconds, recent_cpu / 100, recent_cpu % 100);
+  msg ("recent_cpu decayed during %d seconds asleep.", seconds);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mlfqs-recent-sleep) begin
+(mlfqs-recent-sleep) Sleeping 10 seconds, please wait...
+(mlfqs-recent-sleep) recent_cpu decayed during 10 seconds asleep.
+(mlfqs-recent-sleep) Sleeping 70 seconds, please wait...
+(mlfqs-recent-sleep) recent_cpu decayed during 70 seconds asleep.
+(mlfqs-recent-sleep) PASS
+(mlfqs-recent-sleep) end
+EOF
+pass;
@@ -0,0 +1,61 @@
+/* Checks that a mutex excludes other threads and that, when it
+   is released, it goes to its waiters in priority order.  Unlike
+   a lock, a mutex does not donate priority, so the waiters here
+   all have higher priority than the main thread. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define THREAD_CNT 3
+
+static struct mutex mutex;
+static struct semaphore done;
+
+static void
+acquire_thread_func (void *aux UNUSED) 
+{
+  mutex_lock (&mutex);
+  msg ("%s got the mutex", thread_name ());
+  mutex_unlock (&mutex);
+  sema_up (&done);
+}
+
+void
+test_mutex (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  mutex_init (&mutex);
+  sema_init (&done, 0);
+
+  mutex_lock (&mutex);
+  if (!mutex_held_by_current_thread (&mutex))
+    fail ("mutex not held after mutex_lock");
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, PRI_DEFAULT + 1 + i, acquire_thread_func, NULL);
+    }
+  msg ("%d waiters blocked", THREAD_CNT);
+  mutex_unlock (&mutex);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  if (!mutex_try_lock (&mutex))
+    fail ("free mutex could not be taken");
+  mutex_unlock (&mutex);
+  if (mutex_held_by_current_thread (&mutex))
+    fail ("mutex still held after mutex_unlock");
+  pass ();
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mutex) begin
+(mutex) 3 waiters blocked
+(mutex) waiter 2 got the mutex
+(mutex) waiter 1 got the mutex
+(mutex) waiter 0 got the mutex
+(mutex) PASS
+(mutex) end
+EOF
+pass;
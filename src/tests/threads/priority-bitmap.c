@@ -0,0 +1,77 @@
+/* Creates two threads at every priority below the main thread's,
+   in scrambled order, then blocks the main thread and checks that
+   they ran highest priority first, in creation order within a
+   priority.  The priorities span both words of the ready bitmap. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define PER_LEVEL 2
+#define THREAD_CNT ((PRI_MAX - PRI_MIN) * PER_LEVEL)
+
+struct bitmap_thread_data
+  {
+    int priority;               /* Priority created at. */
+    int id;                     /* Creation order within priority. */
+  };
+
+static thread_func bitmap_thread;
+static struct bitmap_thread_data data[THREAD_CNT];
+static struct bitmap_thread_data *order[THREAD_CNT];
+static int order_cnt;
+static struct semaphore done;
+
+void
+test_priority_bitmap (void)
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  thread_set_priority (PRI_MAX);
+
+  /* 37 and 63 are coprime, so this visits every priority from
+     PRI_MIN to PRI_MAX - 1 once per round, out of order. */
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      struct bitmap_thread_data *d = data + i;
+      char name[16];
+
+      d->priority = PRI_MIN + i * 37 % (PRI_MAX - PRI_MIN);
+      d->id = i / (PRI_MAX - PRI_MIN);
+      snprintf (name, sizeof name, "p%d-%d", d->priority, d->id);
+      thread_create (name, d->priority, bitmap_thread, d);
+    }
+
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      int priority = PRI_MAX - 1 - i / PER_LEVEL;
+      int id = i % PER_LEVEL;
+
+      if (order[i]->priority != priority || order[i]->id != id)
+        fail ("thread %d to run was p%d-%d, expected p%d-%d",
+              i, order[i]->priority, order[i]->id, priority, id);
+    }
+  msg ("%d threads ran in priority order.", THREAD_CNT);
+}
+
+static void
+bitmap_thread (void *d_)
+{
+  struct bitmap_thread_data *d = d_;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  order[order_cnt++] = d;
+  intr_set_level (old_level);
+  sema_up (&done);
+}
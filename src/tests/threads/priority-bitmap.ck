@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-bitmap) begin
+(priority-bitmap) 126 threads ran in priority order.
+(priority-bitmap) end
+EOF
+pass;
@@ -0,0 +1,82 @@
+/* The main thread sets its priority to PRI_MIN, acquires lock 0,
+   and creates 10 threads (thread 1...10) with priorities
+   PRI_MIN + 3, 6, 9, ...  Thread[i] acquires lock[i] (unless
+   i == 10), then blocks acquiring lock[i-1], which forms a chain
+   of waiting holders that ends at the main thread.
+
+   Donation follows the chain through at most 8 holders, so the
+   main thread receives the priority of threads 1...8 but not of
+   threads 9 and 10, which are more than 8 holders away.  After
+   releasing lock 0 the chain unwinds and the main thread drops
+   back to PRI_MIN. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define CHAIN_LENGTH 10
+#define DONATION_DEPTH 8
+
+struct lock_pair
+  {
+    struct lock *second;
+    struct lock *first;
+  };
+
+static thread_func donor_thread_func;
+
+void
+test_priority_donate_deep (void) 
+{
+  struct lock locks[CHAIN_LENGTH];
+  struct lock_pair lock_pairs[CHAIN_LENGTH + 1];
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  thread_set_priority (PRI_MIN);
+
+  for (i = 0; i < CHAIN_LENGTH; i++)
+    lock_init (&locks[i]);
+
+  lock_acquire (&locks[0]);
+  msg ("%s got lock.", thread_name ());
+
+  for (i = 1; i <= CHAIN_LENGTH; i++)
+    {
+      char name[16];
+      int expected;
+
+      snprintf (name, sizeof name, "thread %d", i);
+      lock_pairs[i].first = i < CHAIN_LENGTH ? locks + i : NULL;
+      lock_pairs[i].second = locks + i - 1;
+      thread_create (name, PRI_MIN + i * 3, donor_thread_func,
+                     lock_pairs + i);
+
+      expected = PRI_MIN + (i < DONATION_DEPTH ? i : DONATION_DEPTH) * 3;
+      msg ("%s should have priority %d.  Actual priority: %d.",
+           thread_name (), expected, thread_get_priority ());
+    }
+
+  lock_release (&locks[0]);
+  msg ("%s finishing with priority %d.", thread_name (),
+       thread_get_priority ());
+}
+
+static void
+donor_thread_func (void *locks_) 
+{
+  struct lock_pair *locks = locks_;
+
+  if (locks->first)
+    lock_acquire (locks->first);
+
+  lock_acquire (locks->second);
+  lock_release (locks->second);
+
+  if (locks->first)
+    lock_release (locks->first);
+}
@@ -0,0 +1,60 @@
+/* Creates several threads of the same priority that all block
+   acquiring a lock held by the main thread, then releases the
+   lock.  Verifies that the lock is handed from waiter to waiter
+   in the order they started waiting. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define WAITER_CNT 16
+
+static struct lock lock;
+static int order[WAITER_CNT];
+static int order_cnt;
+
+static thread_func waiter_func;
+
+void
+test_priority_lock_fifo (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lock_init (&lock);
+  lock_acquire (&lock);
+  for (i = 0; i < WAITER_CNT; i++)
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, PRI_DEFAULT + 1, waiter_func, (void *) i);
+
+      /* Waiter I donates its priority to us, so it only gets to
+         block on the lock, behind waiters 0...I-1, if we yield. */
+      thread_yield ();
+    }
+  lock_release (&lock);
+
+  if (order_cnt != WAITER_CNT)
+    fail ("only %d of %d waiters got the lock", order_cnt, WAITER_CNT);
+  for (i = 0; i < WAITER_CNT; i++)
+    if (order[i] != i)
+      fail ("waiter %d got the lock in position %d", order[i], i);
+  msg ("%d waiters got the lock in FIFO order", order_cnt);
+}
+
+static void
+waiter_func (void *aux) 
+{
+  lock_acquire (&lock);
+  order[order_cnt++] = (int) aux;
+  lock_release (&lock);
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-lock-fifo) begin
+(priority-lock-fifo) 16 waiters got the lock in FIFO order
+(priority-lock-fifo) end
+EOF
+pass;
@@ -0,0 +1,125 @@
+/* Measures how late an interactive thread gets the CPU after its
+   sleeps end, while CPU-bound threads compete for it, under each
+   of the three schedulers.
+
+   The main thread sleeps for 1 to 3 ticks at a time, ITERATIONS
+   times, while HOG_CNT threads of the same priority and nice
+   value spin.  Each wakeup's latency is the number of ticks
+   between the end of the sleep and the return from
+   timer_sleep().  The mean, 99th percentile, and maximum are
+   reported.  The test fails if the 99th percentile is above what
+   the scheduler promises: under CFS a woken sleeper preempts the
+   running hog at once, so it may be late only by the tick it takes
+   to get back from the interrupt; round robin and MLFQS may leave
+   it behind one time slice of every hog. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOG_CNT 4
+#define ITERATIONS 200
+#define MAX_LATENCY 64          /* Histogram size, in ticks. */
+
+/* Highest acceptable 99th-percentile latency, in ticks.  4 is
+   TIME_SLICE in threads/thread.c. */
+#define CFS_P99_MAX 1
+#define RR_P99_MAX (HOG_CNT * 4)
+
+static void test_sched_latency (int p99_max);
+static void hog (void *);
+
+static volatile bool stop;
+static struct semaphore hogs_done;
+
+void
+test_sched_latency_prio (void) 
+{
+  ASSERT (!thread_mlfqs && !thread_cfs);
+  test_sched_latency (RR_P99_MAX);
+}
+
+void
+test_sched_latency_mlfqs (void) 
+{
+  ASSERT (thread_mlfqs);
+  test_sched_latency (RR_P99_MAX);
+}
+
+void
+test_sched_latency_cfs (void) 
+{
+  ASSERT (thread_cfs);
+  test_sched_latency (CFS_P99_MAX);
+}
+
+static void
+test_sched_latency (int p99_max) 
+{
+  int histogram[MAX_LATENCY + 1];
+  int64_t total = 0;
+  int p99 = 0, max = 0;
+  int i, seen;
+
+  memset (histogram, 0, sizeof histogram);
+  stop = false;
+  sema_init (&hogs_done, 0);
+  for (i = 0; i < HOG_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "hog %d", i);
+      thread_create (name, PRI_DEFAULT, hog, NULL);
+    }
+
+  /* Let the hogs build up some run time first. */
+  timer_sleep (TIMER_FREQ);
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      int64_t ticks = 1 + i % 3;
+      int64_t wakeup = timer_ticks () + ticks;
+      int64_t late;
+
+      timer_sleep (ticks);
+      late = timer_ticks () - wakeup;
+      if (late < 0)
+        fail ("woke up %lld ticks early", -late);
+      if (late > MAX_LATENCY)
+        late = MAX_LATENCY;
+      histogram[late]++;
+      total += late;
+    }
+
+  stop = true;
+  for (i = 0; i < HOG_CNT; i++)
+    sema_down (&hogs_done);
+
+  for (i = seen = 0; i <= MAX_LATENCY; i++)
+    if (histogram[i] > 0)
+      {
+        if (seen < ITERATIONS * 99 / 100)
+          p99 = i;
+        seen += histogram[i];
+        max = i;
+      }
+
+  msg ("%d wakeups, %d hogs: mean %lld.%02lld, p99 %d, max %d ticks late",
+       ITERATIONS, HOG_CNT, total / ITERATIONS,
+       total * 100 / ITERATIONS % 100, p99, max);
+  if (max >= MAX_LATENCY)
+    fail ("interactive thread starved for %d ticks or more", MAX_LATENCY);
+  if (p99 > p99_max)
+    fail ("p99 latency %d ticks, should be at most %d", p99, p99_max);
+}
+
+static void
+hog (void *aux UNUSED) 
+{
+  while (!stop)
+    continue;
+  sema_up (&hogs_done);
+}
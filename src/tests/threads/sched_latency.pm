@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Checks the output of a sched-latency test, which ends with a
+# line of latency statistics whose values vary from run to run.
+sub check_sched_latency {
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my ($name) = $test =~ m%([^/]+)$%;
+    fail "missing begin message\n"
+      if !@output || $output[0] ne "($name) begin";
+    fail "missing end message\n" if $output[$#output] ne "($name) end";
+
+    my ($stats) = grep (/wakeups, \d+ hogs: mean/, @output);
+    fail "missing latency statistics\n" if !defined $stats;
+    fail join ("\n", @output) . "\n" if grep (/FAIL/, @output);
+    pass $stats;
+}
+
+1;
@@ -11,6 +11,9 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_callback;
+extern test_func test_alarm_wheel;
+extern test_func test_alarm_tickless;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -19,19 +22,29 @@ extern test_func test_priority_donate_sema;
 extern test_func test_priority_donate_nest;
 extern test_func test_priority_donate_lower;
 extern test_func test_priority_donate_chain;
+extern test_func test_priority_donate_deep;
 extern test_func test_priority_fifo;
+extern test_func test_priority_lock_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_priority_bitmap;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
 extern test_func test_mlfqs_recent_1;
+extern test_func test_mlfqs_recent_sleep;
 extern test_func test_mlfqs_fair_2;
 extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_sched_latency_prio;
+extern test_func test_sched_latency_mlfqs;
+extern test_func test_sched_latency_cfs;
+extern test_func test_workqueue;
+extern test_func test_mutex;
+extern test_func test_thread_reuse;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,85 @@
+/* Creates and exits several rounds of threads, many more than the
+   kernel keeps dead threads' pages for, some running at once and
+   some one after another so that pages are reused both from the
+   cache and from the page allocator.  Each thread leaves its
+   struct thread dirty before exiting, and each new thread checks
+   that it starts with the name, priority and argument it was
+   created with and none of a previous thread's state. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define ROUND_CNT 4
+#define THREAD_CNT 40
+
+struct reuse_thread_data
+  {
+    char name[16];              /* Name created with. */
+    int priority;               /* Priority created with. */
+  };
+
+static thread_func reuse_thread;
+static struct reuse_thread_data data[THREAD_CNT];
+static struct semaphore done;
+static struct lock lock;
+
+void
+test_thread_reuse (void)
+{
+  int round, i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  lock_init (&lock);
+
+  for (round = 0; round < ROUND_CNT; round++)
+    {
+      /* Threads above the main thread's priority run and exit
+         right away; those below wait until it blocks. */
+      for (i = 0; i < THREAD_CNT; i++)
+        {
+          struct reuse_thread_data *d = data + i;
+
+          snprintf (d->name, sizeof d->name, "r%d-%d", round, i);
+          d->priority = PRI_DEFAULT + (i % 2 ? 1 : -1);
+          thread_create (d->name, d->priority, reuse_thread, d);
+        }
+      for (i = 0; i < THREAD_CNT; i++)
+        sema_down (&done);
+    }
+  msg ("%d threads in %d rounds started clean.", ROUND_CNT * THREAD_CNT,
+       ROUND_CNT);
+}
+
+static void
+reuse_thread (void *d_)
+{
+  struct reuse_thread_data *d = d_;
+  struct thread *t = thread_current ();
+
+  if (strcmp (thread_name (), d->name))
+    fail ("thread %s started as %s", d->name, thread_name ());
+  if (thread_get_priority () != d->priority
+      || t->original_priority != d->priority)
+    fail ("thread %s started at priority %d, not %d", d->name,
+          thread_get_priority (), d->priority);
+  if (t->nice != 0 || t->recent_cpu != 0)
+    fail ("thread %s started with another thread's nice or recent_cpu",
+          d->name);
+  if (!list_empty (&t->held_locks) || t->wait_on_lock != NULL)
+    fail ("thread %s started with another thread's locks", d->name);
+
+  /* Leave state behind for the next thread to get this page. */
+  lock_acquire (&lock);
+  t->nice = 7;
+  t->recent_cpu = 1234;
+  sema_up (&done);
+  lock_release (&lock);
+  thread_set_priority (PRI_MIN);
+}
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(thread-reuse) begin
+(thread-reuse) 160 threads in 4 rounds started clean.
+(thread-reuse) end
+EOF
+pass;
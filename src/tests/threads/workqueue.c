@@ -0,0 +1,87 @@
+/* Queues work on a workqueue with a single worker thread and
+   checks that it runs in FIFO order, that queuing pending work
+   again and cancelling it both take effect, that delayed work
+   runs no earlier than its delay, and that workqueue_flush()
+   waits for everything queued. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+#define WORK_CNT 5
+
+static int order[WORK_CNT + 1];
+static int order_cnt;
+static int64_t delayed_ticks;
+static struct semaphore delayed_done;
+
+static void
+record (void *aux) 
+{
+  order[order_cnt++] = (int) aux;
+}
+
+static void
+delayed (void *aux UNUSED) 
+{
+  delayed_ticks = timer_ticks ();
+  sema_up (&delayed_done);
+}
+
+void
+test_workqueue (void) 
+{
+  struct workqueue *wq;
+  struct work works[WORK_CNT];
+  struct delayed_work dw, dw_cancelled;
+  int64_t start;
+  int i;
+
+  /* The worker runs below our priority, so nothing we queue
+     runs until we block. */
+  wq = workqueue_create ("test-wq", 1, PRI_DEFAULT - 1);
+  if (wq == NULL)
+    fail ("workqueue_create failed");
+
+  for (i = 0; i < WORK_CNT; i++)
+    {
+      work_init (&works[i], record, (void *) i);
+      if (!queue_work (wq, &works[i]))
+        fail ("work %d could not be queued", i);
+    }
+  if (queue_work (wq, &works[0]))
+    fail ("pending work was queued twice");
+  if (!cancel_work (&works[2]))
+    fail ("pending work could not be cancelled");
+  if (cancel_work (&works[2]))
+    fail ("cancelled work was still pending");
+
+  workqueue_flush (wq);
+  for (i = 0; i < WORK_CNT; i++)
+    if (work_pending (&works[i]))
+      fail ("work %d still pending after flush", i);
+  for (i = 0; i < order_cnt; i++)
+    msg ("work %d ran", order[i]);
+
+  sema_init (&delayed_done, 0);
+  delayed_work_init (&dw, delayed, NULL);
+  delayed_work_init (&dw_cancelled, record, (void *) WORK_CNT);
+  start = timer_ticks ();
+  queue_delayed_work (wq, &dw, 20);
+  queue_delayed_work (wq, &dw_cancelled, 5);
+  if (!cancel_delayed_work (&dw_cancelled))
+    fail ("delayed work could not be cancelled");
+  sema_down (&delayed_done);
+  if (delayed_ticks < start + 20)
+    fail ("delayed work ran %lld ticks early",
+          start + 20 - delayed_ticks);
+  workqueue_flush (wq);
+  if (order_cnt != WORK_CNT - 1)
+    fail ("cancelled delayed work ran");
+  msg ("delayed work ran after its delay");
+  pass ();
+}
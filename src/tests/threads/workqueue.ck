@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) work 0 ran
+(workqueue) work 1 ran
+(workqueue) work 3 ran
+(workqueue) work 4 ran
+(workqueue) delayed work ran after its delay
+(workqueue) PASS
+(workqueue) end
+EOF
+pass;
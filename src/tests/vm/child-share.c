@@ -0,0 +1,53 @@
+/* Child process of page-share-exec.
+   Checks a table of read-only data, which lives in the same
+   read-only pages in every running copy of this program, then
+   dirties 1 MB so that, with the other copies doing the same,
+   those pages are evicted and mapped again, and checks the table
+   once more. */
+
+#include <stdint.h>
+#include "tests/lib.h"
+
+#define SIZE (1024 * 1024)
+static char buf[SIZE];
+
+/* Table entry I. */
+#define V(I) ((uint32_t) ((I) * 2654435761u) ^ (uint32_t) (I))
+#define V4(I) V (I), V ((I) + 1), V ((I) + 2), V ((I) + 3)
+#define V16(I) V4 (I), V4 ((I) + 4), V4 ((I) + 8), V4 ((I) + 12)
+#define V64(I) V16 (I), V16 ((I) + 16), V16 ((I) + 32), V16 ((I) + 48)
+#define V256(I) V64 (I), V64 ((I) + 64), V64 ((I) + 128), V64 ((I) + 192)
+#define V1024(I) V256 (I), V256 ((I) + 256), V256 ((I) + 512),   \
+                 V256 ((I) + 768)
+#define TABLE_CNT 4096          /* 4 pages. */
+
+static const uint32_t table[TABLE_CNT] =
+  {V1024 (0), V1024 (1024), V1024 (2048), V1024 (3072)};
+
+static void
+check_table (void)
+{
+  uint32_t i;
+
+  for (i = 0; i < TABLE_CNT; i++)
+    if (table[i] != V (i))
+      fail ("table[%u] is %#x, should be %#x", i, table[i], V (i));
+}
+
+int
+main (int argc UNUSED, char *argv[] UNUSED)
+{
+  size_t i;
+
+  test_name = "child-share";
+
+  check_table ();
+  for (i = 0; i < SIZE; i++)
+    buf[i] = i;
+  check_table ();
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != (char) i)
+      fail ("byte %zu is wrong", i);
+
+  return 0x42;
+}
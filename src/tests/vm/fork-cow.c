@@ -0,0 +1,42 @@
+/* Forks a child that overwrites a buffer it shares copy-on-write
+   with its parent, and verifies that the parent's copy is
+   unaffected. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (64 * 1024)
+
+static char buf[SIZE];
+
+void
+test_main (void)
+{
+  pid_t child;
+  size_t i;
+
+  memset (buf, 'a', sizeof buf);
+
+  child = fork ();
+  if (child == 0)
+    {
+      /* Child. */
+      for (i = 0; i < sizeof buf; i++)
+        if (buf[i] != 'a')
+          fail ("child sees bad data at offset %zu", i);
+      memset (buf, 'b', sizeof buf);
+      exit (42);
+    }
+
+  quiet = true;
+  CHECK (child != PID_ERROR, "fork");
+  CHECK (wait (child) == 42, "wait for child");
+  quiet = false;
+
+  for (i = 0; i < sizeof buf; i++)
+    if (buf[i] != 'a')
+      fail ("parent's buffer changed at offset %zu", i);
+  msg ("parent's buffer intact");
+}
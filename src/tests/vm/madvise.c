@@ -0,0 +1,33 @@
+/* Exercises madvise(): hints on a file mapping must not change
+   its contents, and MADV_DONTNEED on anonymous memory must make it
+   read back as zeros. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  char *file_map = (char *) 0x10000000;
+  char *anon_map = (char *) 0x20000000;
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (handle, file_map) != MAP_FAILED, "mmap \"sample.txt\"");
+  CHECK (madvise (file_map, 4096, MADV_SEQUENTIAL) == 0, "madvise sequential");
+  CHECK (madvise (file_map, 4096, MADV_WILLNEED) == 0, "madvise willneed");
+  if (memcmp (file_map, sample, strlen (sample)))
+    fail ("read of mmap'd file reported bad data");
+
+  CHECK (mmap_anon (anon_map, 4096) != MAP_FAILED, "mmap_anon");
+  memset (anon_map, 'x', 4096);
+  CHECK (madvise (anon_map, 4096, MADV_DONTNEED) == 0, "madvise dontneed");
+  if (anon_map[0] != 0 || anon_map[4095] != 0)
+    fail ("anonymous page kept its data after MADV_DONTNEED");
+
+  CHECK (madvise (anon_map + 1, 4096, MADV_NORMAL) == -1,
+         "madvise misaligned address (must fail)");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise) begin
+(madvise) open "sample.txt"
+(madvise) mmap "sample.txt"
+(madvise) madvise sequential
+(madvise) madvise willneed
+(madvise) mmap_anon
+(madvise) madvise dontneed
+(madvise) madvise misaligned address (must fail)
+(madvise) end
+EOF
+pass;
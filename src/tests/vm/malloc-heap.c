@@ -0,0 +1,57 @@
+/* Allocates, fills, and frees many blocks of varying size with
+   the user-level malloc(), which grows the heap with sbrk(), and
+   checks that no block overwrites another. */
+
+#include <malloc.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/arc4.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_CNT 512
+#define MAX_SIZE 2000
+
+static char *blocks[BLOCK_CNT];
+static size_t sizes[BLOCK_CNT];
+
+/* Checks that block I still holds its fill pattern. */
+static void
+check_block (size_t i)
+{
+  size_t j;
+
+  for (j = 0; j < sizes[i]; j++)
+    if (blocks[i][j] != (char) i)
+      fail ("block %zu corrupted at offset %zu", i, j);
+}
+
+void
+test_main (void)
+{
+  struct arc4 arc4;
+  void *brk;
+  int round;
+  size_t i;
+
+  arc4_init (&arc4, "malloc-heap", 11);
+  brk = sbrk (0);
+  for (round = 0; round < 4; round++)
+    {
+      for (i = 0; i < BLOCK_CNT; i++)
+        {
+          unsigned char r;
+          arc4_crypt (&arc4, &r, 1);
+          sizes[i] = r * MAX_SIZE / 256 + 1;
+          blocks[i] = malloc (sizes[i]);
+          if (blocks[i] == NULL)
+            fail ("malloc of %zu bytes failed", sizes[i]);
+          memset (blocks[i], i, sizes[i]);
+        }
+      for (i = 0; i < BLOCK_CNT; i++)
+        check_block (i);
+      for (i = 0; i < BLOCK_CNT; i++)
+        free (blocks[i]);
+    }
+  msg ("heap grew by %s", sbrk (0) > brk ? "a positive amount" : "nothing");
+}
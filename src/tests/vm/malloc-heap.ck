@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(malloc-heap) begin
+(malloc-heap) heap grew by a positive amount
+(malloc-heap) end
+EOF
+pass;
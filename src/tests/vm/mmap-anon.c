@@ -0,0 +1,32 @@
+/* Maps anonymous memory, checks that it reads as zeros, writes
+   to it, and unmaps it again. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (3 * 4096 + 100)
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  mapid_t map;
+  size_t i;
+
+  CHECK ((map = mmap_anon (actual, SIZE)) != MAP_FAILED, "mmap_anon");
+  for (i = 0; i < SIZE; i++)
+    if (actual[i] != 0)
+      fail ("byte %zu of anonymous mapping is not zero", i);
+  memset (actual, 'x', SIZE);
+  for (i = 0; i < SIZE; i++)
+    if (actual[i] != 'x')
+      fail ("byte %zu of anonymous mapping did not stick", i);
+  CHECK (mmap_anon (actual + 4096, 4096) == MAP_FAILED,
+         "try to map over existing mapping (must fail)");
+  munmap (map);
+
+  actual[0] = 'x';
+  fail ("unmapped memory is readable (%d)", *actual);
+}
@@ -0,0 +1,105 @@
+/* Maps a file and a large anonymous region, each as a single area,
+   and checks that pages no one has touched yet still count as
+   mapped: overlapping mappings are refused, and the pages read
+   back the right data in the process and in a forked child, in
+   whatever order they are first touched.  Also checks that a
+   mapping running past the top of user memory is refused, and
+   that munmap frees the whole range again. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 5
+#define FILE_SIZE (PAGE_CNT * PAGE_SIZE)
+
+#define FILE_MAP ((char *) 0x10000000)
+#define ANON_MAP ((char *) 0x40000000)
+#define ANON_SIZE (256 * 1024 * 1024)
+
+static char buf[FILE_SIZE];
+
+/* Fails unless page PAGE of the file mapping holds its data. */
+static void
+check_page (int page, const char *who)
+{
+  if (memcmp (FILE_MAP + page * PAGE_SIZE, buf + page * PAGE_SIZE,
+              PAGE_SIZE))
+    fail ("%s sees bad data in page %d of the file mapping", who, page);
+}
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map, anon;
+  pid_t child;
+  size_t i;
+
+  CHECK (create ("area", FILE_SIZE), "create \"area\"");
+  CHECK ((handle = open ("area")) > 1, "open \"area\"");
+  for (i = 0; i < FILE_SIZE; i++)
+    buf[i] = i * 13 % 256;
+  CHECK (write (handle, buf, FILE_SIZE) == FILE_SIZE, "write \"area\"");
+  CHECK ((map = mmap (handle, FILE_MAP)) != MAP_FAILED, "mmap \"area\"");
+
+  /* None of the pages have been touched, but all of them are in use. */
+  CHECK (mmap (handle, FILE_MAP + 2 * PAGE_SIZE) == MAP_FAILED,
+         "mmap over the middle of the mapping must fail");
+  CHECK (mmap_anon (FILE_MAP + (PAGE_CNT - 1) * PAGE_SIZE, PAGE_SIZE)
+         == MAP_FAILED, "mmap_anon over its last page must fail");
+  CHECK (mmap_anon (FILE_MAP - PAGE_SIZE, 2 * PAGE_SIZE) == MAP_FAILED,
+         "mmap_anon over its first page must fail");
+
+  /* Touch the last page first. */
+  check_page (PAGE_CNT - 1, "parent");
+
+  child = fork ();
+  if (child == 0)
+    {
+      int page;
+
+      for (page = PAGE_CNT - 2; page >= 0; page--)
+        check_page (page, "child");
+      exit (42);
+    }
+
+  quiet = true;
+  CHECK (child != PID_ERROR, "fork");
+  CHECK (wait (child) == 42, "wait for child");
+  quiet = false;
+
+  for (i = 0; i < PAGE_CNT - 1; i++)
+    check_page (i, "parent");
+
+  /* A large anonymous mapping, touched only at its ends. */
+  CHECK ((anon = mmap_anon (ANON_MAP, ANON_SIZE)) != MAP_FAILED,
+         "mmap_anon 256 MB");
+  CHECK (mmap_anon (ANON_MAP + ANON_SIZE / 2, PAGE_SIZE) == MAP_FAILED,
+         "mmap_anon inside it must fail");
+  if (ANON_MAP[0] != 0 || ANON_MAP[ANON_SIZE - 1] != 0)
+    fail ("anonymous memory is not zero");
+  ANON_MAP[0] = 'a';
+  ANON_MAP[ANON_SIZE - 1] = 'z';
+  if (ANON_MAP[0] != 'a' || ANON_MAP[ANON_SIZE - 1] != 'z')
+    fail ("anonymous memory lost a store");
+  msg ("ends of the anonymous mapping read back");
+
+  CHECK (mmap_anon ((char *) 0xbff00000, 2 * 1024 * 1024) == MAP_FAILED,
+         "mmap_anon past the top of user memory must fail");
+
+  /* Unmapping frees the whole range, touched or not. */
+  munmap (anon);
+  munmap (map);
+  CHECK ((map = mmap (handle, FILE_MAP + 2 * PAGE_SIZE)) != MAP_FAILED,
+         "mmap over the old file mapping");
+  CHECK ((anon = mmap_anon (ANON_MAP + ANON_SIZE / 2, PAGE_SIZE))
+         != MAP_FAILED, "mmap_anon inside the old anonymous mapping");
+  if (ANON_MAP[ANON_SIZE / 2] != 0)
+    fail ("anonymous memory is not zero after remapping");
+  munmap (anon);
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-area) begin
+(mmap-area) create "area"
+(mmap-area) open "area"
+(mmap-area) write "area"
+(mmap-area) mmap "area"
+(mmap-area) mmap over the middle of the mapping must fail
+(mmap-area) mmap_anon over its last page must fail
+(mmap-area) mmap_anon over its first page must fail
+(mmap-area) mmap_anon 256 MB
+(mmap-area) mmap_anon inside it must fail
+(mmap-area) ends of the anonymous mapping read back
+(mmap-area) mmap_anon past the top of user memory must fail
+(mmap-area) mmap over the old file mapping
+(mmap-area) mmap_anon inside the old anonymous mapping
+(mmap-area) end
+EOF
+pass;
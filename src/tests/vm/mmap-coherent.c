@@ -0,0 +1,82 @@
+/* Checks that write() and read() on a file see the same data as
+   a memory mapping of it, without munmap() in between: data
+   written with write() shows up in the mapping, and stores made
+   through the mapping show up in read().  Covers both a whole
+   page and the partial page at the end of the file. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+
+/* Two full pages and part of a third. */
+#define FILE_SIZE (2 * 4096 + 100)
+
+static char buf[FILE_SIZE];
+
+/* Fills the SIZE bytes at P with a pattern that depends on SEED. */
+static void
+fill (char *p, size_t size, int seed)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    p[i] = (i * 7 + seed) % 251;
+}
+
+void
+test_main (void)
+{
+  char chunk[200];
+  int handle;
+  mapid_t map;
+  size_t i;
+
+  CHECK (create ("coherent", FILE_SIZE), "create \"coherent\"");
+  CHECK ((handle = open ("coherent")) > 1, "open \"coherent\"");
+  fill (buf, FILE_SIZE, 1);
+  CHECK (write (handle, buf, FILE_SIZE) == FILE_SIZE, "write \"coherent\"");
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"coherent\"");
+
+  /* Fault every page in before writing, so that write() has to
+     update resident pages rather than just the disk. */
+  if (memcmp (ACTUAL, buf, FILE_SIZE))
+    fail ("mapping does not match file");
+
+  /* write() -> mapping, in the middle page and in the last,
+     partial page. */
+  fill (chunk, sizeof chunk, 2);
+  seek (handle, 4096 + 300);
+  CHECK (write (handle, chunk, sizeof chunk) == sizeof chunk,
+         "write into page 1");
+  if (memcmp (ACTUAL + 4096 + 300, chunk, sizeof chunk))
+    fail ("write() to page 1 not seen through mapping");
+  seek (handle, FILE_SIZE - 50);
+  CHECK (write (handle, chunk, sizeof chunk) == 50,
+         "write up to end of file");
+  if (memcmp (ACTUAL + FILE_SIZE - 50, chunk, 50))
+    fail ("write() to last page not seen through mapping");
+  for (i = FILE_SIZE; i < 3 * 4096; i++)
+    if (ACTUAL[i] != 0)
+      fail ("byte %zu past end of file is %02hhx, not 0", i, ACTUAL[i]);
+
+  /* Mapping -> read(). */
+  fill (ACTUAL, 4096, 3);
+  fill (ACTUAL + 2 * 4096, 100, 4);
+  seek (handle, 0);
+  CHECK (read (handle, buf, FILE_SIZE) == FILE_SIZE, "read \"coherent\"");
+  if (memcmp (buf, ACTUAL, FILE_SIZE))
+    fail ("stores through mapping not seen by read()");
+
+  munmap (map);
+
+  /* And the stores made it to the file. */
+  fill (chunk, 100, 4);
+  seek (handle, 2 * 4096);
+  CHECK (read (handle, buf, 100) == 100, "read last page after munmap");
+  if (memcmp (buf, chunk, 100))
+    fail ("stores through mapping lost by munmap()");
+  close (handle);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-coherent) begin
+(mmap-coherent) create "coherent"
+(mmap-coherent) open "coherent"
+(mmap-coherent) write "coherent"
+(mmap-coherent) mmap "coherent"
+(mmap-coherent) write into page 1
+(mmap-coherent) write up to end of file
+(mmap-coherent) read "coherent"
+(mmap-coherent) read last page after munmap
+(mmap-coherent) end
+EOF
+pass;
@@ -0,0 +1,98 @@
+/* Maps a file twice, back to back, and walks through the first
+   mapping so that fault-around maps pages ahead of each fault, up
+   to and past the end of the mapping.  Checks that every page
+   holds the right data, including the zero fill past the end of
+   the file and the second mapping's pages that fault-around may
+   have brought in from the first, that stores to pages that were
+   mapped ahead reach the file, and that a backward walk, which
+   fault-around backs off from, reads the right data too. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+/* 12 full pages and part of a 13th. */
+#define PAGE_CNT 13
+#define FILE_SIZE ((PAGE_CNT - 1) * PAGE_SIZE + 100)
+
+#define FIRST ((char *) 0x10000000)
+#define SECOND (FIRST + PAGE_CNT * PAGE_SIZE)
+#define THIRD ((char *) 0x20000000)
+
+static char buf[FILE_SIZE];
+
+/* Fills the SIZE bytes at P with a pattern that depends on SEED. */
+static void
+fill (char *p, size_t size, int seed)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    p[i] = (i * 7 + seed) % 251;
+}
+
+/* Fails unless the mapping at P holds BUF, followed by zeros to the
+   end of the last page. */
+static void
+check_mapping (const char *p, const char *name)
+{
+  size_t i;
+
+  if (memcmp (p, buf, FILE_SIZE))
+    fail ("%s mapping does not match the file", name);
+  for (i = FILE_SIZE; i < PAGE_CNT * PAGE_SIZE; i++)
+    if (p[i] != 0)
+      fail ("byte %zu of %s mapping, past end of file, is %02hhx", i, name,
+            p[i]);
+}
+
+void
+test_main (void)
+{
+  int handle[3];
+  mapid_t map[3];
+  size_t i;
+
+  CHECK (create ("around", FILE_SIZE), "create \"around\"");
+  for (i = 0; i < 3; i++)
+    CHECK ((handle[i] = open ("around")) > 1, "open \"around\"");
+  fill (buf, FILE_SIZE, 1);
+  CHECK (write (handle[0], buf, FILE_SIZE) == FILE_SIZE, "write \"around\"");
+  CHECK ((map[0] = mmap (handle[0], FIRST)) != MAP_FAILED, "mmap at first");
+  CHECK ((map[1] = mmap (handle[1], SECOND)) != MAP_FAILED,
+         "mmap right after it");
+
+  /* Walk forward, one byte per page. */
+  for (i = 0; i < PAGE_CNT; i++)
+    if (FIRST[i * PAGE_SIZE] != buf[i * PAGE_SIZE])
+      fail ("page %zu read forward does not match the file", i);
+  check_mapping (FIRST, "first");
+  check_mapping (SECOND, "second");
+
+  /* Store into pages that were mapped ahead of a fault. */
+  fill (FIRST + PAGE_SIZE, FILE_SIZE - PAGE_SIZE, 2);
+  munmap (map[0]);
+  munmap (map[1]);
+  fill (buf + PAGE_SIZE, FILE_SIZE - PAGE_SIZE, 2);
+  seek (handle[2], 0);
+  {
+    static char file[FILE_SIZE];
+    CHECK (read (handle[2], file, FILE_SIZE) == FILE_SIZE, "read \"around\"");
+    if (memcmp (file, buf, FILE_SIZE))
+      fail ("stores to pages mapped ahead did not reach the file");
+  }
+
+  /* Walk backward. */
+  CHECK ((map[2] = mmap (handle[2], THIRD)) != MAP_FAILED, "mmap again");
+  for (i = PAGE_CNT; i-- > 0; )
+    if (memcmp (THIRD + i * PAGE_SIZE, buf + i * PAGE_SIZE,
+                i == PAGE_CNT - 1 ? FILE_SIZE % PAGE_SIZE : PAGE_SIZE))
+      fail ("page %zu read backward does not match the file", i);
+  munmap (map[2]);
+
+  for (i = 0; i < 3; i++)
+    close (handle[i]);
+}
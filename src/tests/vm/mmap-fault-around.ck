@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-fault-around) begin
+(mmap-fault-around) create "around"
+(mmap-fault-around) open "around"
+(mmap-fault-around) open "around"
+(mmap-fault-around) open "around"
+(mmap-fault-around) write "around"
+(mmap-fault-around) mmap at first
+(mmap-fault-around) mmap right after it
+(mmap-fault-around) read "around"
+(mmap-fault-around) mmap again
+(mmap-fault-around) end
+EOF
+pass;
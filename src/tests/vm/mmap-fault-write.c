@@ -0,0 +1,105 @@
+/* Forks a child that keeps writing to a file while the parent
+   maps the file several times and faults its pages in, so that
+   writes land while the parent's faults are reading the same
+   pages.  Each round of writes goes to a different word of every
+   page, so a page that was cached without one of the writes stays
+   wrong.  Verifies that afterward every mapping, and read(), see
+   every write. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 16
+#define ROUND_CNT 64
+#define MAP_CNT 8
+#define FILE_SIZE (PAGE_CNT * PAGE_SIZE)
+
+/* Address of mapping I. */
+#define MAP_ADDR(I) ((char *) 0x10000000 + (I) * 0x100000)
+
+/* Writes round R's word into every page of the file open as
+   HANDLE. */
+static void
+write_round (int handle, int r)
+{
+  int p;
+
+  for (p = 0; p < PAGE_CNT; p++)
+    {
+      seek (handle, p * PAGE_SIZE + r * sizeof r);
+      if (write (handle, &r, sizeof r) != sizeof r)
+        fail ("write round %d to page %d", r, p);
+    }
+}
+
+/* Fails unless the PAGE_CNT pages at P hold every round's word.
+   WHAT describes P. */
+static void
+check_pages (const char *p, const char *what)
+{
+  int page, r;
+
+  for (page = 0; page < PAGE_CNT; page++)
+    for (r = 1; r <= ROUND_CNT; r++)
+      {
+        int word;
+
+        memcpy (&word, p + page * PAGE_SIZE + r * sizeof r, sizeof word);
+        if (word != r)
+          fail ("%s: page %d has %d for round %d", what, page, word, r);
+      }
+}
+
+static char buf[FILE_SIZE];
+
+void
+test_main (void)
+{
+  pid_t child;
+  int handle;
+  int i, r;
+
+  CHECK (create ("racy", FILE_SIZE), "create \"racy\"");
+
+  child = fork ();
+  if (child == 0)
+    {
+      /* Child. */
+      handle = open ("racy");
+      if (handle < 2)
+        fail ("child could not open \"racy\"");
+      for (r = 1; r <= ROUND_CNT; r++)
+        write_round (handle, r);
+      exit (0);
+    }
+
+  quiet = true;
+  CHECK (child != PID_ERROR, "fork");
+  CHECK ((handle = open ("racy")) > 1, "open \"racy\"");
+
+  /* Fault the pages in while the child writes, keeping every
+     mapping so that a stale page stays in the page cache. */
+  for (i = 0; i < MAP_CNT; i++)
+    {
+      int page;
+
+      CHECK (mmap (handle, MAP_ADDR (i)) != MAP_FAILED, "mmap %d", i);
+      for (page = 0; page < PAGE_CNT; page++)
+        buf[0] += MAP_ADDR (i)[page * PAGE_SIZE];
+    }
+  CHECK (wait (child) == 0, "wait for child");
+  quiet = false;
+
+  for (i = 0; i < MAP_CNT; i++)
+    check_pages (MAP_ADDR (i), "mapping");
+  msg ("mappings saw every write");
+
+  seek (handle, 0);
+  CHECK (read (handle, buf, FILE_SIZE) == FILE_SIZE, "read \"racy\"");
+  check_pages (buf, "read()");
+  msg ("read() saw every write");
+  close (handle);
+}
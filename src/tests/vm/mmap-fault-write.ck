@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-fault-write) begin
+mmap-fault-write: exit(0)
+(mmap-fault-write) mappings saw every write
+(mmap-fault-write) read() saw every write
+(mmap-fault-write) end
+mmap-fault-write: exit(0)
+EOF
+pass;
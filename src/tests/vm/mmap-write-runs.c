@@ -0,0 +1,81 @@
+/* Dirties pages of a mapping in runs of different lengths,
+   including one longer than munmap() writes back at once and one
+   that ends in the partial last page of the file, with clean pages
+   between them, and checks after munmap() that the file holds the
+   new data in exactly the dirtied pages and has not grown. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((char *) 0x10000000)
+#define PAGE_SIZE 4096
+
+/* 21 full pages and part of a 22nd. */
+#define PAGE_CNT 22
+#define FILE_SIZE ((PAGE_CNT - 1) * PAGE_SIZE + 100)
+
+/* Whether each page is written through the mapping: runs of 10, 1,
+   2 and 6 pages. */
+static const bool dirty[PAGE_CNT] =
+  {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1};
+
+static char buf[FILE_SIZE];
+
+/* Fills the SIZE bytes at P with page IDX of version SEED of the
+   file. */
+static void
+fill (char *p, size_t idx, size_t size, int seed)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    p[i] = (idx * 13 + i * 7 + seed) % 251;
+}
+
+/* Returns the number of file bytes in page IDX. */
+static size_t
+page_bytes (size_t idx)
+{
+  return idx == PAGE_CNT - 1 ? FILE_SIZE % PAGE_SIZE : PAGE_SIZE;
+}
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map;
+  size_t i;
+
+  CHECK (create ("runs", FILE_SIZE), "create \"runs\"");
+  CHECK ((handle = open ("runs")) > 1, "open \"runs\"");
+  for (i = 0; i < PAGE_CNT; i++)
+    fill (buf + i * PAGE_SIZE, i, page_bytes (i), 1);
+  CHECK (write (handle, buf, FILE_SIZE) == FILE_SIZE, "write \"runs\"");
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"runs\"");
+
+  /* Read every page, so that the clean ones are resident too, then
+     dirty some. */
+  if (memcmp (ACTUAL, buf, FILE_SIZE))
+    fail ("mapping does not match file");
+  for (i = 0; i < PAGE_CNT; i++)
+    if (dirty[i])
+      fill (ACTUAL + i * PAGE_SIZE, i, page_bytes (i), 2);
+  munmap (map);
+
+  CHECK (filesize (handle) == FILE_SIZE, "file size unchanged");
+  seek (handle, 0);
+  CHECK (read (handle, buf, FILE_SIZE) == FILE_SIZE, "read \"runs\"");
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      char expected[PAGE_SIZE];
+
+      fill (expected, i, page_bytes (i), dirty[i] ? 2 : 1);
+      if (memcmp (buf + i * PAGE_SIZE, expected, page_bytes (i)))
+        fail ("page %zu of the file does not hold its %s data", i,
+              dirty[i] ? "new" : "original");
+    }
+  msg ("file holds the new data in exactly the dirtied pages");
+  close (handle);
+}
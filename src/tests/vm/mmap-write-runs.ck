@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-write-runs) begin
+(mmap-write-runs) create "runs"
+(mmap-write-runs) open "runs"
+(mmap-write-runs) write "runs"
+(mmap-write-runs) mmap "runs"
+(mmap-write-runs) file size unchanged
+(mmap-write-runs) read "runs"
+(mmap-write-runs) file holds the new data in exactly the dirtied pages
+(mmap-write-runs) end
+EOF
+pass;
@@ -0,0 +1,23 @@
+/* Runs 4 child-share processes at once.  Their read-only pages
+   are shared, and each child checks that the data it sees in them
+   stays right while memory pressure evicts and remaps them. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 4
+
+void
+test_main (void)
+{
+  pid_t children[CHILD_CNT];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    CHECK ((children[i] = exec ("child-share")) != -1,
+           "exec \"child-share\"");
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    CHECK (wait (children[i]) == 0x42, "wait for child %d", i);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-share-exec) begin
+(page-share-exec) exec "child-share"
+(page-share-exec) exec "child-share"
+(page-share-exec) exec "child-share"
+(page-share-exec) exec "child-share"
+(page-share-exec) wait for child 0
+(page-share-exec) wait for child 1
+(page-share-exec) wait for child 2
+(page-share-exec) wait for child 3
+(page-share-exec) end
+EOF
+pass;
@@ -0,0 +1,86 @@
+/* Fills 2 MB of memory, more than fits in the user pool, with a
+   different pattern on each page, then verifies every page going
+   forward and backward, rewrites some pages, and verifies all of
+   them again.  Even pages hold a repeated word and compress well,
+   so they are evicted to the compressed swap cache; odd pages hold
+   random bytes and go to the swap device.  Reading the pages in
+   order faults them back in clusters of adjacent swap slots. */
+
+#include <string.h>
+#include "tests/arc4.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (2 * 1024 * 1024)
+#define PAGE_SIZE 4096
+#define PAGE_CNT (SIZE / PAGE_SIZE)
+
+static char buf[SIZE];
+static int gens[PAGE_CNT];     /* Generation each page holds. */
+
+/* Fills PAGE with the contents expected for page number IDX in
+   generation GEN. */
+static void
+make_page (char *page, size_t idx, int gen)
+{
+  if (idx % 2 == 0)
+    {
+      unsigned *word = (unsigned *) page;
+      size_t i;
+
+      for (i = 0; i < PAGE_SIZE / sizeof *word; i++)
+        word[i] = idx * 16 + gen;
+    }
+  else
+    {
+      struct arc4 arc4;
+      size_t key = idx * 16 + gen;
+
+      memset (page, 0, PAGE_SIZE);
+      arc4_init (&arc4, &key, sizeof key);
+      arc4_crypt (&arc4, page, PAGE_SIZE);
+    }
+}
+
+/* Verifies page IDX of buf against generation GEN. */
+static void
+check_page (size_t idx, int gen)
+{
+  char expected[PAGE_SIZE];
+
+  make_page (expected, idx, gen);
+  if (memcmp (buf + idx * PAGE_SIZE, expected, PAGE_SIZE))
+    fail ("page %zu does not hold generation %d", idx, gen);
+}
+
+void
+test_main (void)
+{
+  size_t i;
+
+  msg ("write pass");
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      gens[i] = 0;
+      make_page (buf + i * PAGE_SIZE, i, 0);
+    }
+
+  msg ("forward read pass");
+  for (i = 0; i < PAGE_CNT; i++)
+    check_page (i, gens[i]);
+
+  msg ("backward read pass");
+  for (i = PAGE_CNT; i-- > 0; )
+    check_page (i, gens[i]);
+
+  msg ("rewrite pass");
+  for (i = 0; i < PAGE_CNT; i += 3)
+    {
+      gens[i] = 1;
+      make_page (buf + i * PAGE_SIZE, i, 1);
+    }
+
+  msg ("final read pass");
+  for (i = 0; i < PAGE_CNT; i++)
+    check_page (i, gens[i]);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-swap-verify) begin
+(page-swap-verify) write pass
+(page-swap-verify) forward read pass
+(page-swap-verify) backward read pass
+(page-swap-verify) rewrite pass
+(page-swap-verify) final read pass
+(page-swap-verify) end
+EOF
+pass;
@@ -0,0 +1,64 @@
+/* Reads pages of a buffer that was never written, which maps them
+   to the shared zero frame, then writes one of them in the parent
+   and another in a forked child.  Verifies that each write lands
+   in a private copy of the page, leaving the other pages, and the
+   other process's view of the page, zero. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 4
+
+static char buf[PAGE_CNT * PAGE_SIZE];
+
+/* Fails unless page IDX of buf is all zeros. */
+static void
+check_zero (size_t idx, const char *who)
+{
+  size_t i;
+
+  for (i = 0; i < PAGE_SIZE; i++)
+    if (buf[idx * PAGE_SIZE + i] != 0)
+      fail ("%s sees nonzero byte at offset %zu of page %zu", who, i, idx);
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+  size_t i;
+
+  /* Read every page before writing any. */
+  for (i = 0; i < PAGE_CNT; i++)
+    check_zero (i, "parent");
+
+  memset (buf + PAGE_SIZE, 'p', PAGE_SIZE);
+  for (i = 0; i < PAGE_CNT; i++)
+    if (i != 1)
+      check_zero (i, "parent");
+  msg ("parent's write stayed in its page");
+
+  child = fork ();
+  if (child == 0)
+    {
+      /* Child. */
+      memset (buf + 2 * PAGE_SIZE, 'c', PAGE_SIZE);
+      for (i = 0; i < PAGE_SIZE; i++)
+        if (buf[PAGE_SIZE + i] != 'p')
+          fail ("child sees bad data at offset %zu of page 1", i);
+      check_zero (0, "child");
+      check_zero (3, "child");
+      exit (42);
+    }
+
+  quiet = true;
+  CHECK (child != PID_ERROR, "fork");
+  CHECK (wait (child) == 42, "wait for child");
+  quiet = false;
+
+  check_zero (2, "parent");
+  msg ("child's write stayed in its copy");
+}
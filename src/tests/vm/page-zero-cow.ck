@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(page-zero-cow) begin
+(page-zero-cow) parent's write stayed in its page
+page-zero-cow: exit(42)
+(page-zero-cow) child's write stayed in its copy
+(page-zero-cow) end
+page-zero-cow: exit(0)
+EOF
+pass;
@@ -359,6 +359,10 @@ intr_handler (struct intr_frame *frame)
 
       in_external_intr = true;
       yield_on_return = false;
+
+      /* Restart the clock if this ends a tickless idle. */
+      if (frame->vec_no != 0x20)
+        timer_idle_exit ();
     }
 
   /* Invoke the interrupt's handler. */
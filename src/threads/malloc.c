@@ -40,7 +40,7 @@ struct desc
     size_t block_size;          /* Size of each element in bytes. */
     size_t blocks_per_arena;    /* Number of blocks in an arena. */
     struct list free_list;      /* List of free blocks. */
-    struct lock lock;           /* Lock. */
+    struct mutex lock;          /* Lock. */
   };
 
 /* Magic number for detecting arena corruption. */
@@ -80,7 +80,7 @@ malloc_init (void)
       d->block_size = block_size;
       d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
       list_init (&d->free_list);
-      lock_init (&d->lock);
+      mutex_init (&d->lock);
     }
 }
 
@@ -119,25 +119,25 @@ malloc (size_t size)
       return a + 1;
     }
 
-  lock_acquire (&d->lock);
+  mutex_lock (&d->lock);
 
   /* If the free list is empty, create a new arena. */
   if (list_empty (&d->free_list))
     {
       size_t i;
 
-      /* Allocate a page. */
+      /* Allocate a page.  The page allocator may sleep, so the
+         descriptor is unlocked meanwhile. */
+      mutex_unlock (&d->lock);
       a = palloc_get_page (0);
       if (a == NULL) 
-        {
-          lock_release (&d->lock);
-          return NULL; 
-        }
+        return NULL; 
 
       /* Initialize arena and add its blocks to the free list. */
       a->magic = ARENA_MAGIC;
       a->desc = d;
       a->free_cnt = d->blocks_per_arena;
+      mutex_lock (&d->lock);
       for (i = 0; i < d->blocks_per_arena; i++) 
         {
           struct block *b = arena_to_block (a, i);
@@ -149,7 +149,7 @@ malloc (size_t size)
   b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
   a = block_to_arena (b);
   a->free_cnt--;
-  lock_release (&d->lock);
+  mutex_unlock (&d->lock);
   return b;
 }
 
@@ -233,12 +233,15 @@ free (void *p)
           memset (b, 0xcc, d->block_size);
 #endif
   
-          lock_acquire (&d->lock);
+          struct arena *unused = NULL;
+
+          mutex_lock (&d->lock);
 
           /* Add block to free list. */
           list_push_front (&d->free_list, &b->free_elem);
 
-          /* If the arena is now entirely unused, free it. */
+          /* If the arena is now entirely unused, free it once the
+             descriptor is unlocked. */
           if (++a->free_cnt >= d->blocks_per_arena) 
             {
               size_t i;
@@ -249,10 +252,11 @@ free (void *p)
                   struct block *b = arena_to_block (a, i);
                   list_remove (&b->free_elem);
                 }
-              palloc_free_page (a);
+              unused = a;
             }
 
-          lock_release (&d->lock);
+          mutex_unlock (&d->lock);
+          palloc_free_page (unused);
         }
       else
         {
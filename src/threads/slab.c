@@ -0,0 +1,206 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Object caches.
+
+   malloc() serves every size from a handful of power-of-2 block
+   sizes, so a 60-byte object takes a 64-byte block and a 68-byte
+   one a 128-byte block.  Kernel objects that are allocated and
+   freed all the time, such as the descriptors of user pages and
+   frames, instead get a cache of their own that hands out objects
+   of exactly their size.
+
+   A cache takes memory from the page allocator one page, called a
+   "slab", at a time.  The slab starts with a header and is divided
+   into objects after it; the slab's free objects are chained
+   through their first word.  Slabs with free objects are kept on
+   the cache's partial list, which allocation takes from, and slabs
+   that are used up on its full list.  When a slab's last object is
+   freed, the page goes back to the page allocator, unless it is
+   the only slab left with free objects: keeping that one avoids
+   getting and giving back a page on every allocation when a
+   cache's usage goes back and forth across a slab boundary.
+
+   Objects are not initialized: a cache has no constructor, so
+   the common path is popping an object off a list. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab0bec
+
+/* Slab header. */
+struct slab
+  {
+    unsigned magic;             /* Always set to SLAB_MAGIC. */
+    struct slab_cache *cache;   /* Owning cache. */
+    size_t free_cnt;            /* Number of free objects. */
+    void *free;                 /* First free object. */
+    struct list_elem elem;      /* Element in partial or full list. */
+  };
+
+/* Offset of the first object from the start of a slab. */
+#define SLAB_OBJS_OFS ROUND_UP (sizeof (struct slab), sizeof (void *))
+
+/* All caches, for slab_print_stats(). */
+static struct list cache_list = LIST_INITIALIZER (cache_list);
+
+static struct slab *obj_to_slab (struct slab_cache *, void *);
+
+/* Initializes CACHE, named NAME, to hand out SIZE-byte objects. */
+void
+slab_cache_init (struct slab_cache *cache, const char *name, size_t size)
+{
+  ASSERT (size > 0);
+
+  cache->name = name;
+  cache->obj_size = ROUND_UP (size, sizeof (void *));
+  cache->objs_per_slab = (PGSIZE - SLAB_OBJS_OFS) / cache->obj_size;
+  ASSERT (cache->objs_per_slab > 0);
+  list_init (&cache->partial);
+  list_init (&cache->full);
+  mutex_init (&cache->lock);
+  cache->slab_cnt = 0;
+  cache->in_use = 0;
+  cache->peak = 0;
+  list_push_back (&cache_list, &cache->elem);
+}
+
+/* Obtains and returns an object from CACHE.  Its contents are
+   undefined.  Returns a null pointer if memory is not available. */
+void *
+slab_alloc (struct slab_cache *cache)
+{
+  struct slab *s;
+  void *obj;
+
+  mutex_lock (&cache->lock);
+
+  /* If no slab has a free object, create a new one.  The page
+     allocator may sleep, so the cache is unlocked meanwhile. */
+  if (list_empty (&cache->partial))
+    {
+      uint8_t *p;
+      size_t i;
+
+      mutex_unlock (&cache->lock);
+      s = palloc_get_page (0);
+      if (s == NULL)
+        return NULL;
+
+      /* Initialize the slab and chain its objects together. */
+      s->magic = SLAB_MAGIC;
+      s->cache = cache;
+      s->free_cnt = cache->objs_per_slab;
+      s->free = NULL;
+      p = (uint8_t *) s + SLAB_OBJS_OFS + cache->objs_per_slab * cache->obj_size;
+      for (i = 0; i < cache->objs_per_slab; i++)
+        {
+          p -= cache->obj_size;
+          *(void **) p = s->free;
+          s->free = p;
+        }
+
+      mutex_lock (&cache->lock);
+      list_push_front (&cache->partial, &s->elem);
+      cache->slab_cnt++;
+    }
+
+  /* Take an object from the first partial slab. */
+  s = list_entry (list_front (&cache->partial), struct slab, elem);
+  obj = s->free;
+  s->free = *(void **) obj;
+  if (--s->free_cnt == 0)
+    {
+      list_remove (&s->elem);
+      list_push_back (&cache->full, &s->elem);
+    }
+  if (++cache->in_use > cache->peak)
+    cache->peak = cache->in_use;
+
+  mutex_unlock (&cache->lock);
+  return obj;
+}
+
+/* Returns OBJ, which must have been obtained from CACHE, to it.
+   A null OBJ is ignored. */
+void
+slab_free (struct slab_cache *cache, void *obj)
+{
+  struct slab *s;
+  struct slab *unused = NULL;
+
+  if (obj == NULL)
+    return;
+
+  s = obj_to_slab (cache, obj);
+
+#ifndef NDEBUG
+  /* Clear the object to help detect use-after-free bugs. */
+  memset (obj, 0xcc, cache->obj_size);
+#endif
+
+  mutex_lock (&cache->lock);
+
+  *(void **) obj = s->free;
+  s->free = obj;
+  cache->in_use--;
+
+  if (s->free_cnt++ == 0)
+    {
+      /* The slab was full.  Make it the first to allocate from. */
+      list_remove (&s->elem);
+      list_push_front (&cache->partial, &s->elem);
+    }
+  else if (s->free_cnt == cache->objs_per_slab
+           && (list_begin (&cache->partial) != &s->elem
+               || list_next (&s->elem) != list_end (&cache->partial)))
+    {
+      /* The slab is unused and not the last one with free
+         objects.  Give it back, once the cache is unlocked. */
+      list_remove (&s->elem);
+      s->magic = 0;
+      unused = s;
+      cache->slab_cnt--;
+    }
+
+  mutex_unlock (&cache->lock);
+  palloc_free_page (unused);
+}
+
+/* Returns the slab that OBJ, an object of CACHE, belongs to. */
+static struct slab *
+obj_to_slab (struct slab_cache *cache, void *obj)
+{
+  struct slab *s = pg_round_down (obj);
+
+  /* Check that the slab is valid and OBJ is one of its objects. */
+  ASSERT (s != NULL);
+  ASSERT (s->magic == SLAB_MAGIC);
+  ASSERT (s->cache == cache);
+  ASSERT (pg_ofs (obj) >= SLAB_OBJS_OFS);
+  ASSERT ((pg_ofs (obj) - SLAB_OBJS_OFS) % cache->obj_size == 0);
+
+  return s;
+}
+
+/* Prints the usage of each cache. */
+void
+slab_print_stats (void)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&cache_list); e != list_end (&cache_list);
+       e = list_next (e))
+    {
+      struct slab_cache *cache = list_entry (e, struct slab_cache, elem);
+      printf ("Slab %s: %zu objects of %zu bytes in use (peak %zu), "
+              "%zu slabs\n",
+              cache->name, cache->in_use, cache->obj_size, cache->peak,
+              cache->slab_cnt);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <list.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+/* An object cache: a source of objects of a single type. */
+struct slab_cache
+  {
+    const char *name;           /* Name, for slab_print_stats(). */
+    size_t obj_size;            /* Size of each object in bytes. */
+    size_t objs_per_slab;       /* Number of objects in a slab. */
+    struct list partial;        /* Slabs with at least one free object. */
+    struct list full;           /* Slabs with no free objects. */
+    struct mutex lock;          /* Lock. */
+    size_t slab_cnt;            /* Number of slabs. */
+    size_t in_use;              /* Objects allocated. */
+    size_t peak;                /* Largest IN_USE so far. */
+    struct list_elem elem;      /* Element in list of all caches. */
+  };
+
+void slab_cache_init (struct slab_cache *, const char *name, size_t size);
+void *slab_alloc (struct slab_cache *) __attribute__ ((malloc));
+void slab_free (struct slab_cache *, void *);
+void slab_print_stats (void);
+
+#endif /* threads/slab.h */
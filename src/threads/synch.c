@@ -32,6 +32,13 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
+/* Most holders a donation is passed through, for bounding the
+   work a lock_acquire() does on a long chain of waiting
+   holders. */
+#define DONATION_DEPTH_MAX 8
+
+static rb_less_func waiter_more_priority;
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -167,42 +174,83 @@ sema_test_helper (void *sema_)
    is, it is an error for the thread currently holding a lock to
    try to acquire that lock.
 
-   A lock is a specialization of a semaphore with an initial
-   value of 1.  The difference between a lock and such a
-   semaphore is twofold.  First, a semaphore can have a value
-   greater than 1, but a lock can only be owned by a single
-   thread at a time.  Second, a semaphore does not have an owner,
-   meaning that one thread can "down" the semaphore and then
-   another one "up" it, but with a lock the same thread must both
-   acquire and release it.  When these restrictions prove
-   onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
+   A lock is like a semaphore with an initial value of 1.  The
+   difference between a lock and such a semaphore is twofold.
+   First, a semaphore can have a value greater than 1, but a lock
+   can only be owned by a single thread at a time.  Second, a
+   semaphore does not have an owner, meaning that one thread can
+   "down" the semaphore and then another one "up" it, but with a
+   lock the same thread must both acquire and release it.  When
+   these restrictions prove onerous, it's a good sign that a
+   semaphore should be used, instead of a lock.
+
+   Because a lock has an owner, a thread waiting for it donates
+   its priority to the holder.  The waiters are kept in a tree
+   ordered by priority, so that the highest of them, which is
+   both the priority donated through the lock and the thread the
+   lock is handed to on release, is found without a scan.  A
+   holder's effective priority is the highest of its own and the
+   first waiter of each lock it holds. */
 void
 lock_init (struct lock *lock)
 {
   ASSERT (lock != NULL);
 
   lock->holder = NULL;
-  sema_init (&lock->semaphore, 1);
+  rb_init (&lock->waiters, waiter_more_priority, NULL);
 }
 
-bool set_donators_to_priority_descending (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
+/* Orders lock waiters by descending priority.  Waiters of equal
+   priority stay in arrival order. */
+static bool
+waiter_more_priority (const struct rb_elem *a, const struct rb_elem *b,
+                      void *aux UNUSED)
 {
-  struct thread *ta = list_entry (a, struct thread, d_elem);
-  struct thread *tb = list_entry (b, struct thread, d_elem);
+  return (rb_entry (a, struct thread, waiter_elem)->priority
+          > rb_entry (b, struct thread, waiter_elem)->priority);
+}
 
-  return ta->priority > tb->priority;
+/* Returns the priority LOCK donates to its holder, or PRI_MIN if
+   nobody waits for it. */
+int
+lock_donated_priority (const struct lock *lock)
+{
+  struct rb_elem *first = rb_min (&lock->waiters);
+
+  if (first == NULL)
+    return PRI_MIN;
+  return rb_entry (first, struct thread, waiter_elem)->priority;
 }
 
-// Tracked_thread's priority is always bigger than priority of both lock-holder thread and donator threads
-void
-donate_priority(struct thread *tracked_thread) {
-  if (tracked_thread->wait_on_lock == NULL) {
-    return;
-  }
-  struct thread *holder_thread = tracked_thread->wait_on_lock->holder;
-  holder_thread->priority = tracked_thread->priority;
-  donate_priority(holder_thread);
+/* Passes the priority of T, which has just started waiting for
+   a lock, down the chain of holders: the holder of T's lock,
+   the holder of the lock that one waits for, and so on, raising
+   each to T's priority.  A holder that is itself waiting is
+   moved to its new place among its lock's waiters.  Stops at a
+   holder that already has T's priority or better, or after
+   DONATION_DEPTH_MAX holders.  Interrupts must be off. */
+static void
+donate_priority (struct thread *t)
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; depth < DONATION_DEPTH_MAX && t->wait_on_lock != NULL;
+       depth++)
+    {
+      struct thread *holder = t->wait_on_lock->holder;
+      struct lock *next = holder->wait_on_lock;
+
+      if (holder->priority >= t->priority)
+        break;
+      if (next != NULL)
+        rb_remove (&next->waiters, &holder->waiter_elem);
+      thread_change_priority (holder, t->priority);
+      if (next != NULL)
+        rb_insert (&next->waiters, &holder->waiter_elem);
+      t = holder;
+    }
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -216,22 +264,31 @@ donate_priority(struct thread *tracked_thread) {
 void
 lock_acquire (struct lock *lock)
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  struct thread *current_thread = thread_current();
-  struct thread *lock_holder = lock->holder;
-
-  if (lock_holder != NULL && !thread_mlfqs) {
-    current_thread->wait_on_lock = lock;
-    list_insert_ordered(&lock_holder->donators_list, &current_thread->d_elem, set_donators_to_priority_descending, NULL);
-    donate_priority(current_thread);
-  }
-
-  sema_down (&lock->semaphore);
-  current_thread->wait_on_lock = NULL;
-  lock->holder = current_thread;
+  old_level = intr_disable ();
+  if (lock->holder != NULL)
+    {
+      /* lock_release() hands the lock straight to us, so there
+         is no need to check again after waking up. */
+      cur->wait_on_lock = lock;
+      rb_insert (&lock->waiters, &cur->waiter_elem);
+      if (!thread_mlfqs)
+        donate_priority (cur);
+      thread_block ();
+      ASSERT (lock->holder == cur);
+    }
+  else
+    {
+      lock->holder = cur;
+      list_push_back (&cur->held_locks, &lock->elem);
+    }
+  intr_set_level (old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -243,18 +300,31 @@ lock_acquire (struct lock *lock)
 bool
 lock_try_acquire (struct lock *lock)
 {
+  enum intr_level old_level;
   bool success;
 
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
-  success = sema_try_down (&lock->semaphore);
+  old_level = intr_disable ();
+  success = lock->holder == NULL;
   if (success)
-    lock->holder = thread_current ();
+    {
+      lock->holder = thread_current ();
+      list_push_back (&lock->holder->held_locks, &lock->elem);
+    }
+  intr_set_level (old_level);
   return success;
 }
 
-/* Releases LOCK, which must be owned by the current thread.
+/* Releases LOCK, which must be owned by the current thread, and
+   hands it to its highest-priority waiter, if any.
+
+   The new holder's priority needs no update: it was the highest
+   of the waiters, so what the remaining ones donate is no more
+   than it already has.  Only the releasing thread's priority is
+   recomputed, from the locks it still holds, so the cost does
+   not depend on how many threads wait.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to release a lock within an interrupt
@@ -262,24 +332,32 @@ lock_try_acquire (struct lock *lock)
 void
 lock_release (struct lock *lock) 
 {
+  struct thread *next = NULL;
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
-  struct thread *current_thread = thread_current();
-  struct list_elem *e;
+  old_level = intr_disable ();
+  list_remove (&lock->elem);
+  if (!thread_mlfqs)
+    update_current_thread_priority_with_donators ();
 
-  if (!thread_mlfqs) {
-    for (e = list_begin(&current_thread->donators_list); e != list_end(&current_thread->donators_list); e = list_next(e)) {
-      struct thread *donator = list_entry(e, struct thread, d_elem);
-      if (donator->wait_on_lock == lock){
-        list_remove(&donator->d_elem);
-      }
+  if (!rb_empty (&lock->waiters))
+    {
+      next = rb_entry (rb_min (&lock->waiters), struct thread, waiter_elem);
+      rb_remove (&lock->waiters, &next->waiter_elem);
+      next->wait_on_lock = NULL;
+      lock->holder = next;
+      list_push_back (&next->held_locks, &lock->elem);
+      thread_unblock (next);
     }
-    update_current_thread_priority_with_donators();
-  }
+  else
+    lock->holder = NULL;
+  intr_set_level (old_level);
 
-  lock->holder = NULL;
-  sema_up (&lock->semaphore);
+  if (next != NULL)
+    thread_preemption ();
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -395,3 +473,153 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   while (!list_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/* Mutexes.
+
+   A lock always goes through the interrupt-disabled slow path,
+   since it must keep its waiters and donations up to date.  A
+   mutex is for short critical sections, where that overhead is
+   most of the cost: taking a free mutex, and releasing one that
+   nobody waits for, is a single compare-and-swap on OWNER, with
+   interrupts left alone.
+
+   OWNER holds the holding thread's address, with MUTEX_WAITERS
+   or'd in while the waiter list is not empty, so that the
+   uncontended release can tell from OWNER alone that it has
+   nobody to wake.  A thread that finds the mutex held sets
+   MUTEX_WAITERS and blocks: with one CPU the holder cannot be
+   running at the same time, so spinning would only waste the
+   rest of the time slice.  Like semaphores, the blocking path
+   relies on interrupts being off.
+   On release a waiter is handed the mutex directly.
+
+   Mutexes don't donate priority, so a thread must not sleep while
+   holding one, not even in the page allocator, whose pools are
+   guarded by locks.  Use a lock for data that is held across waits
+   by threads of differing priority. */
+
+/* Flag in a mutex's OWNER: there are waiters. */
+#define MUTEX_WAITERS ((uintptr_t) 1)
+
+/* Atomically replaces *P by NEW if it is OLD.  Returns true if
+   successful, false if *P was not OLD. */
+static inline bool
+mutex_cmpxchg (volatile uintptr_t *p, uintptr_t old, uintptr_t new)
+{
+  uintptr_t prev;
+
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p) : "r" (new), "0" (old) : "memory");
+  return prev == old;
+}
+
+/* Returns the thread holding MUTEX, or a null pointer. */
+static inline struct thread *
+mutex_owner (const struct mutex *mutex)
+{
+  return (struct thread *) (mutex->owner & ~MUTEX_WAITERS);
+}
+
+/* Initializes MUTEX as unlocked. */
+void
+mutex_init (struct mutex *mutex)
+{
+  ASSERT (mutex != NULL);
+
+  mutex->owner = 0;
+  list_init (&mutex->waiters);
+}
+
+/* Acquires MUTEX, sleeping until it becomes available if
+   necessary.  The mutex must not already be held by the current
+   thread.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+mutex_lock (struct mutex *mutex)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (mutex != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!mutex_held_by_current_thread (mutex));
+
+  if (mutex_cmpxchg (&mutex->owner, 0, (uintptr_t) cur))
+    return;
+
+  old_level = intr_disable ();
+  for (;;)
+    {
+      uintptr_t owner = mutex->owner;
+
+      if (owner == 0)
+        {
+          if (mutex_cmpxchg (&mutex->owner, 0, (uintptr_t) cur))
+            break;
+        }
+      else if (mutex_cmpxchg (&mutex->owner, owner, owner | MUTEX_WAITERS))
+        {
+          /* mutex_unlock() hands the mutex straight to us. */
+          list_insert_ordered (&mutex->waiters, &cur->elem,
+                               set_list_to_priority_descending, NULL);
+          thread_block ();
+          ASSERT (mutex_owner (mutex) == cur);
+          break;
+        }
+    }
+  intr_set_level (old_level);
+}
+
+/* Tries to acquire MUTEX and returns true if successful or
+   false on failure.  The mutex must not already be held by the
+   current thread.
+
+   This function will not sleep, so it may be called within an
+   interrupt handler. */
+bool
+mutex_try_lock (struct mutex *mutex)
+{
+  ASSERT (mutex != NULL);
+  ASSERT (!mutex_held_by_current_thread (mutex));
+
+  return mutex_cmpxchg (&mutex->owner, 0, (uintptr_t) thread_current ());
+}
+
+/* Releases MUTEX, which must be owned by the current thread, and
+   hands it to its highest-priority waiter, if any. */
+void
+mutex_unlock (struct mutex *mutex)
+{
+  struct thread *cur = thread_current ();
+  struct thread *next;
+  enum intr_level old_level;
+
+  ASSERT (mutex != NULL);
+  ASSERT (mutex_held_by_current_thread (mutex));
+
+  if (mutex_cmpxchg (&mutex->owner, (uintptr_t) cur, 0))
+    return;
+
+  /* MUTEX_WAITERS is set, and only we can clear it. */
+  old_level = intr_disable ();
+  ASSERT (!list_empty (&mutex->waiters));
+  next = list_entry (list_pop_front (&mutex->waiters), struct thread, elem);
+  mutex->owner = ((uintptr_t) next
+                  | (list_empty (&mutex->waiters) ? 0 : MUTEX_WAITERS));
+  thread_unblock (next);
+  intr_set_level (old_level);
+
+  thread_preemption ();
+}
+
+/* Returns true if the current thread holds MUTEX, false
+   otherwise. */
+bool
+mutex_held_by_current_thread (const struct mutex *mutex)
+{
+  ASSERT (mutex != NULL);
+
+  return mutex_owner (mutex) == thread_current ();
+}
@@ -2,7 +2,9 @@
 #define THREADS_SYNCH_H
 
 #include <list.h>
+#include <rbtree.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* A counting semaphore. */
 struct semaphore 
@@ -20,19 +22,17 @@ void sema_self_test (void);
 /* Lock. */
 struct lock 
   {
-    struct thread *holder;      /* Thread holding lock (for debugging). */
-    struct semaphore semaphore; /* Binary semaphore controlling access. */
+    struct thread *holder;      /* Thread holding lock, or null. */
+    struct rb_tree waiters;     /* Waiting threads, highest priority first. */
+    struct list_elem elem;      /* Element in holder's held_locks. */
   };
 
 void lock_init (struct lock *);
-
-// My priority donation function
-void donate_priority(struct thread *tracked_thread);
-
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+int lock_donated_priority (const struct lock *);
 
 /* Condition variable. */
 struct condition 
@@ -47,7 +47,20 @@ void cond_broadcast (struct condition *, struct lock *);
 
 // My helper function for semaphore reordering
 bool more_sema_priority(const struct list_elem *a, const struct list_elem *b, void *);
-bool set_donators_to_priority_descending (const struct list_elem *a, const struct list_elem *b, void *);
+
+/* Mutex, for short critical sections that never sleep.  Cheaper
+   than a lock when uncontended, but does not donate priority. */
+struct mutex 
+  {
+    volatile uintptr_t owner;   /* Holding thread | MUTEX_WAITERS, or 0. */
+    struct list waiters;        /* Blocked threads, highest priority first. */
+  };
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_try_lock (struct mutex *);
+void mutex_unlock (struct mutex *);
+bool mutex_held_by_current_thread (const struct mutex *);
 
 /* Optimization barrier.
 
@@ -2,6 +2,7 @@
 #include <debug.h>
 #include <stddef.h>
 #include <random.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/flags.h"
@@ -21,12 +22,19 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-
-// List of blocked state thread
-static struct list sleep_list;
+/* Run queue: processes in THREAD_READY state, that is, processes
+   that are ready to run but not actually running.  There is one
+   FIFO queue per priority, and a bitmap with bit PRI_MAX - P set if
+   the queue for priority P is not empty, so that the scan for the
+   highest priority with a ready process is a bsf instruction.
+   Under the completely fair scheduler, ready processes are instead
+   kept in cfs_tree ordered by vruntime. */
+#define PRI_CNT (PRI_MAX - PRI_MIN + 1)
+static struct list ready_queues[PRI_CNT];
+static uint32_t ready_bitmap[DIV_ROUND_UP (PRI_CNT, 32)];
+static size_t ready_cnt;        /* Number of ready processes. */
+static struct rb_tree cfs_tree; /* Ready processes by vruntime. */
+static int64_t min_vruntime;    /* Never decreases. */
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
@@ -41,6 +49,15 @@ static struct thread *initial_thread;
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
+/* Pages of dead threads, kept for thread_create() to reuse
+   instead of going back to the page allocator, which takes the
+   pool lock.  init_thread() clears the struct thread at the
+   bottom of the page, and nothing relies on the rest of the page,
+   the stack, being zeroed. */
+#define THREAD_CACHE_MAX 16
+static struct thread *thread_cache[THREAD_CACHE_MAX];
+static size_t thread_cache_cnt;
+
 /* Stack frame for kernel_thread(). */
 struct kernel_thread_frame 
   {
@@ -64,17 +81,70 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 bool thread_mlfqs;
 fp_t load_avg;
 
+/* Completely fair scheduler.
+
+   Each thread accumulates vruntime while it runs, at a rate
+   inversely proportional to its weight, which is given by its
+   nice value: CFS_TICK per tick at nice 0, and about 1.25 times
+   faster per nice step.  The ready thread with the least vruntime
+   runs next, and the running thread is preempted once it is
+   CFS_TICK ahead of it.  A thread that wakes up is placed no
+   further back than CFS_SLEEPER_CREDIT behind min_vruntime, so that sleeping earns it a little priority but
+   not the CPU for as long as it slept. */
+bool thread_cfs;
+
+#define NICE_MIN (-20)
+#define NICE_MAX 20
+#define CFS_TICK 1024                   /* vruntime of a nice 0 tick. */
+#define CFS_SLEEPER_CREDIT (3 * CFS_TICK)
+#define CFS_WAKEUP_GRAN CFS_TICK
+
+/* Weight by nice value, from NICE_MIN up. */
+static const int cfs_weights[NICE_MAX - NICE_MIN + 1] =
+  {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+    /*  20 */    12,
+  };
+
+static void cfs_tick (struct thread *);
+static void cfs_update_min_vruntime (struct thread *cur);
+static bool should_preempt (struct thread *cur, struct thread *next);
+
+/* recent_cpu decay.  Running and ready threads are decayed every
+   second; a blocked thread is caught up when it wakes, using the
+   decay factors of the seconds it missed.  decay_history[E %
+   DECAY_HISTORY] is the factor applied at the end of second E, and
+   decay_epoch counts the seconds so far. */
+#define DECAY_HISTORY 64
+static fp_t decay_history[DECAY_HISTORY];
+static unsigned decay_epoch;
+
+static void mlfqs_catch_up (struct thread *);
+static void thread_wakeup (void *t);
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
 static struct thread *running_thread (void);
 static struct thread *next_thread_to_run (void);
 static void init_thread (struct thread *, const char *name, int priority);
+static void ready_push (struct thread *);
+static void ready_remove (struct thread *);
+static struct thread *ready_highest (void);
 static bool is_thread (struct thread *) UNUSED;
 static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static struct thread *alloc_thread_page (void);
+static void free_thread_page (struct thread *);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -92,12 +162,15 @@ static tid_t allocate_tid (void);
 void
 thread_init (void) 
 {
+  int i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
   lock_init (&tid_lock);
-  list_init (&ready_list);
+  for (i = 0; i < PRI_CNT; i++)
+    list_init (&ready_queues[i]);
+  rb_init (&cfs_tree, thread_vruntime_less, NULL);
   list_init (&all_list);
-  list_init (&sleep_list);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
@@ -144,10 +217,72 @@ thread_tick (void)
     kernel_ticks++;
 
   /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  if (thread_cfs)
+    cfs_tick (t);
+  else if (++thread_ticks >= TIME_SLICE)
     intr_yield_on_return ();
 }
 
+/* Charges the running thread T for one tick of CPU time, and
+   preempts it if it has got CFS_TICK ahead of the next thread. */
+static void
+cfs_tick (struct thread *t) 
+{
+  struct thread *next;
+
+  if (t == idle_thread)
+    return;
+
+  t->vruntime += (int64_t) CFS_TICK * cfs_weights[0 - NICE_MIN]
+                 / cfs_weights[t->nice - NICE_MIN];
+
+  cfs_update_min_vruntime (t);
+  next = ready_highest ();
+  if (next != NULL && t->vruntime - next->vruntime >= CFS_TICK)
+    intr_yield_on_return ();
+}
+
+/* Advances min_vruntime to the least vruntime among CUR, the
+   running thread, and the ready threads. */
+static void
+cfs_update_min_vruntime (struct thread *cur) 
+{
+  int64_t least = INT64_MAX;
+  struct rb_elem *e = rb_min (&cfs_tree);
+
+  if (cur != idle_thread && cur->status == THREAD_RUNNING)
+    least = cur->vruntime;
+  if (e != NULL)
+    {
+      struct thread *t = rb_entry (e, struct thread, rb_elem);
+      if (t->vruntime < least)
+        least = t->vruntime;
+    }
+  if (least != INT64_MAX && least > min_vruntime)
+    min_vruntime = least;
+}
+
+/* Returns true if NEXT, which has become ready, should take the
+   CPU from CUR, the running thread. */
+static bool
+should_preempt (struct thread *cur, struct thread *next) 
+{
+  if (cur == idle_thread)
+    return true;
+  if (thread_cfs)
+    return next->vruntime + CFS_WAKEUP_GRAN < cur->vruntime;
+  return next->priority > cur->priority;
+}
+
+/* Orders threads by vruntime, for CFS run queues. */
+bool
+thread_vruntime_less (const struct rb_elem *a, const struct rb_elem *b,
+                      void *aux UNUSED)
+{
+  return (rb_entry (a, struct thread, rb_elem)->vruntime
+          < rb_entry (b, struct thread, rb_elem)->vruntime);
+}
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) 
@@ -184,7 +319,7 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = alloc_thread_page ();
   if (t == NULL)
     return TID_ERROR;
 
@@ -237,6 +372,11 @@ thread_create (const char *name, int priority,
 
   /* mmap_table init */
   list_init(&t->mmap_list);
+  t->fault_around_last = NULL;
+  t->fault_around_pages = fault_around_window;
+  t->rss = 0;
+  t->ws_target = 0;
+  t->pf_cnt = 0;
 
   /* Add to run queue. */
   thread_unblock (t);
@@ -287,9 +427,26 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  list_insert_ordered(&ready_list, &t->elem, set_list_to_priority_descending, NULL);
-
+  if (thread_mlfqs && t != idle_thread) {
+    mlfqs_catch_up (t);
+    t->priority = mlfqs_calculate_priority(t->recent_cpu, t->nice);
+  }
+  if (thread_cfs) {
+    /* Sleeper credit. */
+    int64_t floor = min_vruntime - CFS_SLEEPER_CREDIT;
+    if (t->vruntime < floor) {
+      t->vruntime = floor;
+    }
+  }
+  ready_push (t);
   t->status = THREAD_READY;
+
+  /* A woken interactive thread should not wait for the end of a
+     CPU hog's slice. */
+  if (thread_cfs && intr_context ()
+      && should_preempt (running_thread (), t)) {
+    intr_yield_on_return ();
+  }
   intr_set_level (old_level);
 }
 
@@ -361,9 +518,8 @@ thread_yield (void)
 
   old_level = intr_disable ();
   if (cur != idle_thread) {
-    list_insert_ordered(&ready_list, &cur->elem, set_list_to_priority_descending, NULL);
+    ready_push (cur);
   }
-    
   cur->status = THREAD_READY;
   schedule ();
   intr_set_level (old_level);
@@ -371,30 +527,25 @@ thread_yield (void)
 
 void
 thread_preemption (void) {
-  if (list_empty(&ready_list)) {
-    return;
-  }
-  struct thread *ready_thread = list_entry(list_front(&ready_list), struct thread, elem);
   struct thread *current = thread_current();
-  if (!intr_context()&&(current->priority < ready_thread->priority)) {
-    thread_yield();
-  }
-  return;
-}
-
-/* wakeup time comparing function */
-bool less_wakeup_time (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED)
-{
-  struct thread *ta = list_entry (a, struct thread, elem);
-  struct thread *tb = list_entry (b, struct thread, elem);
+  enum intr_level old_level = intr_disable ();
+  struct thread *ready_thread;
+  bool preempt = false;
 
-  if (ta->wakeup_time == tb->wakeup_time) {
-    return ta->priority > tb->priority;
+  ready_thread = ready_highest ();
+  if (ready_thread != NULL) {
+    preempt = should_preempt (current, ready_thread);
   }
+  intr_set_level (old_level);
 
-  return ta->wakeup_time < tb->wakeup_time;
+  if (!intr_context() && preempt) {
+    thread_yield();
+  }
+  return;
 }
 
+/* Blocks the current thread until timer_ticks() reaches
+   TIME_TO_WAKEUP. */
 void
 thread_sleep(int64_t time_to_wakeup)
 {
@@ -404,34 +555,18 @@ thread_sleep(int64_t time_to_wakeup)
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
-  if (cur == idle_thread) {
-    return;
+  if (cur != idle_thread) {
+    timer_add(&cur->sleep_timer, time_to_wakeup);
+    thread_block();
   }
-  cur->wakeup_time = time_to_wakeup;
-  list_insert_ordered(&sleep_list, &cur->elem, less_wakeup_time, NULL);
-  thread_block();
-
   intr_set_level(old_level);
 }
 
-
-void
-thread_wakeup(const int64_t current_time)
+/* Sleep timer callback: wakes up thread T. */
+static void
+thread_wakeup (void *t)
 {
-  struct list_elem *iter = list_begin(&sleep_list);
-  while (iter != list_end(&sleep_list))
-  {
-    struct thread *t = list_entry(iter, struct thread, elem);
-    if (current_time >= t->wakeup_time)
-    {
-      iter = list_remove(iter);
-      thread_unblock(t);
-    }
-    else
-    {
-      break;
-    }
-  }
+  thread_unblock (t);
 }
 
 
@@ -452,21 +587,26 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
+/* Recomputes the current thread's effective priority as the
+   highest of its own priority and those donated through the
+   locks it holds.  Interrupts must be off. */
 void
 update_current_thread_priority_with_donators (void)
 {
   struct thread *current_thread = thread_current ();
-  int original_priority_of_current = current_thread->original_priority;
-  
-  if (list_empty (&current_thread->donators_list)) {
-    current_thread->priority = original_priority_of_current;
-    return;
-  }
+  int priority = current_thread->original_priority;
+  struct list_elem *e;
 
-  int biggest_priority_of_donator_list = list_entry (list_front(&current_thread->donators_list), struct thread, d_elem)->priority;
-  original_priority_of_current = (biggest_priority_of_donator_list > original_priority_of_current) ? biggest_priority_of_donator_list : original_priority_of_current;  
+  ASSERT (intr_get_level () == INTR_OFF);
 
-  current_thread->priority = original_priority_of_current;
+  for (e = list_begin (&current_thread->held_locks);
+       e != list_end (&current_thread->held_locks); e = list_next (e))
+    {
+      int donated = lock_donated_priority (list_entry (e, struct lock, elem));
+      if (donated > priority)
+        priority = donated;
+    }
+  current_thread->priority = priority;
 }
 
 /*
@@ -490,17 +630,52 @@ mlfqs_calculate_priority (fp_t recent_cpu, int nice)
   }
 }
 
-/* recent_cpu = decay * recent_cpu + nice, decay = (2*load_avg)/(2*load_avg+1) */
+/* decay = (2*load_avg)/(2*load_avg+1) */
+fp_t
+mlfqs_calculate_decay (void) {
+  return fp_divide_x_by_y(fp_multiply_x_by_n(load_avg, 2), fp_add_x_and_n(fp_multiply_x_by_n(load_avg, 2), 1));
+}
+
+/* recent_cpu = decay * recent_cpu + nice */
 fp_t
-mlfqs_calculate_recent_cpu (fp_t recent_cpu, int nice) {
-  fp_t decay = fp_divide_x_by_y(fp_multiply_x_by_n(load_avg, 2), fp_add_x_and_n(fp_multiply_x_by_n(load_avg, 2), 1));
+mlfqs_calculate_recent_cpu (fp_t recent_cpu, fp_t decay, int nice) {
   return fp_add_x_and_n(fp_multiply_x_by_y(decay, recent_cpu), nice);
 }
 
+/* Applies to T's recent_cpu the decays of the seconds it spent
+   blocked.  Seconds older than DECAY_HISTORY are folded into one
+   step using the oldest remembered factor d, since n steps of
+   r = d*r + nice give d^n * r + nice * (1 - d^n) / (1 - d). */
+static void
+mlfqs_catch_up (struct thread *t) {
+  unsigned missed = decay_epoch - t->decay_epoch;
+
+  if (missed > DECAY_HISTORY) {
+    fp_t d = decay_history[(decay_epoch - DECAY_HISTORY) % DECAY_HISTORY];
+    fp_t dn = fp_n_to_fp(1), base = d;
+    unsigned n;
+
+    for (n = missed - DECAY_HISTORY; n > 0; n /= 2) {
+      if (n & 1) {
+        dn = fp_multiply_x_by_y(dn, base);
+      }
+      base = fp_multiply_x_by_y(base, base);
+    }
+    t->recent_cpu = fp_add(fp_multiply_x_by_y(dn, t->recent_cpu),
+                           fp_divide_x_by_y(fp_multiply_x_by_n(fp_n_to_fp(1) - dn, t->nice),
+                                            fp_n_to_fp(1) - d));
+    missed = DECAY_HISTORY;
+  }
+  for (; missed > 0; missed--) {
+    t->recent_cpu = mlfqs_calculate_recent_cpu(t->recent_cpu, decay_history[(decay_epoch - missed) % DECAY_HISTORY], t->nice);
+  }
+  t->decay_epoch = decay_epoch;
+}
+
 /* load_avg = (59/60)*load_avg + (1/60)*ready_threads */
 void
 update_load_avg (void) {
-  int ready_threads = list_size(&ready_list);
+  int ready_threads = ready_cnt;
 
   /* include running thread if not a idle */
   if (thread_current () != idle_thread){
@@ -521,23 +696,63 @@ increment_recent_cpu_on_every_tick (void) {
   }
 }
 
+/* Between two once-a-second decays only the running thread's
+   recent_cpu changes, so it is the only priority to recompute. */
 void
-mlfqs_set_priority_of_all_thread (void) {
-  struct list_elem *e;
-  for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)) {
-    struct thread *t = list_entry (e, struct thread, allelem);
-    if (t != idle_thread) {
-      t->priority = mlfqs_calculate_priority(t->recent_cpu, t->nice);// 추상화 레벨 맞춰서 리팩터링 하는게 좋긴한데 지금 고치기는 좀 귀찮다
-    }
+mlfqs_set_priority_of_current_thread (void) {
+  struct thread *cur = thread_current();
+  struct thread *next;
+
+  if (cur == idle_thread) {
+    return;
+  }
+  cur->priority = mlfqs_calculate_priority(cur->recent_cpu, cur->nice);
+  next = ready_highest();
+  if (next != NULL && next->priority > cur->priority) {
+    intr_yield_on_return();
   }
 }
 
+/* Decays recent_cpu of the running and ready threads and requeues
+   the ready ones at their new priorities.  Blocked threads are left
+   to mlfqs_catch_up(). */
 void
-mlfqs_set_recent_cpu_of_all_thread (void) {
-  struct list_elem *e;
-  for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e)) {
-    struct thread *t = list_entry (e, struct thread, allelem);
-    t->recent_cpu = mlfqs_calculate_recent_cpu(t->recent_cpu, t->nice);
+mlfqs_set_recent_cpu_of_ready_threads (void) {
+  struct thread *cur = thread_current();
+  fp_t decay = mlfqs_calculate_decay();
+  struct list ready;
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  decay_history[decay_epoch % DECAY_HISTORY] = decay;
+  decay_epoch++;
+
+  if (cur != idle_thread) {
+    cur->recent_cpu = mlfqs_calculate_recent_cpu(cur->recent_cpu, decay, cur->nice);
+    cur->decay_epoch = decay_epoch;
+  }
+
+  /* Empty the run queues, highest priority first so that the
+     order among equal priorities survives the requeue. */
+  list_init (&ready);
+  for (i = PRI_CNT - 1; i >= 0; i--) {
+    if (!list_empty (&ready_queues[i])) {
+      list_splice (list_end (&ready), list_begin (&ready_queues[i]),
+                   list_end (&ready_queues[i]));
+    }
+  }
+  memset (ready_bitmap, 0, sizeof ready_bitmap);
+  ready_cnt = 0;
+
+  while (!list_empty (&ready)) {
+    struct thread *t = list_entry (list_pop_front (&ready), struct thread, elem);
+    if (t != idle_thread) {
+      t->recent_cpu = mlfqs_calculate_recent_cpu(t->recent_cpu, decay, t->nice);
+      t->decay_epoch = decay_epoch;
+      t->priority = mlfqs_calculate_priority(t->recent_cpu, t->nice);
+    }
+    ready_push (t);
   }
 }
 
@@ -548,8 +763,10 @@ thread_set_priority (int new_priority)
 { 
   /* Disable priority setting when mlfqs */
   if (!thread_mlfqs) {
+    enum intr_level old_level = intr_disable ();
     thread_current ()->original_priority = new_priority;
     update_current_thread_priority_with_donators();
+    intr_set_level (old_level);
     thread_preemption();
   }
 }
@@ -568,11 +785,12 @@ thread_set_nice (int nice UNUSED)
   old_level = intr_disable();
 
   struct thread *t = thread_current();
-  t->nice = nice;
+  t->nice = nice < NICE_MIN ? NICE_MIN : nice > NICE_MAX ? NICE_MAX : nice;
 
   if(t != idle_thread){
-    t->priority = mlfqs_calculate_priority(t->recent_cpu, t->nice);
-    list_sort (&ready_list, set_list_to_priority_descending, NULL);
+    if (!thread_cfs) {
+      t->priority = mlfqs_calculate_priority(t->recent_cpu, t->nice);
+    }
     thread_preemption();
   }
  
@@ -622,10 +840,10 @@ thread_get_recent_cpu (void)
 
    The idle thread is initially put on the ready list by
    thread_start().  It will be scheduled once initially, at which
-   point it initializes idle_thread, "up"s the semaphore passed
-   to it to enable thread_start() to continue, and immediately
-   blocks.  After that, the idle thread never appears in the
-   ready list.  It is returned by next_thread_to_run() as a
+   point it initializes idle_thread, "up"s the semaphore
+   passed to it to enable thread_start() to continue, and
+   immediately blocks.  After that, the idle thread never appears
+   in the ready list.  It is returned by next_thread_to_run() as a
    special case when the ready list is empty. */
 static void
 idle (void *idle_started_ UNUSED) 
@@ -639,6 +857,7 @@ idle (void *idle_started_ UNUSED)
       /* Let someone else run. */
       intr_disable ();
       thread_block ();
+      timer_idle_enter ();
 
       /* Re-enable interrupts and wait for the next one.
 
@@ -706,18 +925,23 @@ init_thread (struct thread *t, const char *name, int priority)
   t->priority = priority;
   t->magic = THREAD_MAGIC;
 
+  t->vruntime = min_vruntime;
+
   old_level = intr_disable ();
   list_push_back (&all_list, &t->allelem);
   intr_set_level (old_level);
 
   /* Initailize thread's field for priority donation */
-  list_init (&t->donators_list);
+  list_init (&t->held_locks);
   t->wait_on_lock = NULL;
   t->original_priority = priority;
 
   /* Initialize mlfqs */
   t->recent_cpu = 0;
   t->nice = 0;
+  t->decay_epoch = decay_epoch;
+
+  timer_setup (&t->sleep_timer, thread_wakeup, t);
 
   /* parent-child list */
   list_init (&(t->child_process_list));
@@ -744,10 +968,107 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
-    return idle_thread;
+  struct thread *t;
+
+  if (thread_cfs)
+    cfs_update_min_vruntime (running_thread ());
+  t = ready_highest ();
+  if (t != NULL)
+    ready_remove (t);
+  else
+    t = idle_thread;
+  return t;
+}
+
+/* Adds T to the back of the run queue for its priority.
+   Interrupts must be off. */
+static void
+ready_push (struct thread *t)
+{
+  int bit = PRI_MAX - t->priority;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_cfs)
+    rb_insert (&cfs_tree, &t->rb_elem);
+  else
+    {
+      list_push_back (&ready_queues[t->priority - PRI_MIN], &t->elem);
+      ready_bitmap[bit / 32] |= 1u << (bit % 32);
+    }
+  ready_cnt++;
+}
+
+/* Removes T, which must be ready, from the run queue.  Interrupts
+   must be off. */
+static void
+ready_remove (struct thread *t)
+{
+  int bit = PRI_MAX - t->priority;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (t->status == THREAD_READY);
+
+  if (thread_cfs)
+    rb_remove (&cfs_tree, &t->rb_elem);
+  else
+    {
+      list_remove (&t->elem);
+      if (list_empty (&ready_queues[t->priority - PRI_MIN]))
+        ready_bitmap[bit / 32] &= ~(1u << (bit % 32));
+    }
+  ready_cnt--;
+}
+
+/* Returns the ready process that should run next, the oldest one
+   of the highest priority, or under CFS the one with the least
+   vruntime, or a null pointer if there is none.  Interrupts must
+   be off. */
+static struct thread *
+ready_highest (void)
+{
+  size_t i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_cfs)
+    {
+      struct rb_elem *e = rb_min (&cfs_tree);
+      return e != NULL ? rb_entry (e, struct thread, rb_elem) : NULL;
+    }
+
+  for (i = 0; i < sizeof ready_bitmap / sizeof *ready_bitmap; i++)
+    if (ready_bitmap[i] != 0)
+      {
+        uint32_t bit;
+        asm ("bsfl %1, %0" : "=r" (bit) : "rm" (ready_bitmap[i]));
+        return list_entry (list_front (&ready_queues[PRI_MAX
+                                                     - (i * 32 + bit)
+                                                     - PRI_MIN]),
+                           struct thread, elem);
+      }
+  return NULL;
+}
+
+/* Sets T's effective priority to PRIORITY, moving T to the run
+   queue for that priority if it is ready. */
+void
+thread_change_priority (struct thread *t, int priority)
+{
+  enum intr_level old_level;
+
+  ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+  old_level = intr_disable ();
+  if (t->status == THREAD_READY && t->priority != priority && !thread_cfs)
+    {
+      ready_remove (t);
+      t->priority = priority;
+      ready_push (t);
+    }
   else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+    t->priority = priority;
+  intr_set_level (old_level);
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -792,8 +1113,45 @@ thread_schedule_tail (struct thread *prev)
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      free_thread_page (prev);
+    }
+}
+
+/* Returns a page for a new thread, from the cache of dead
+   threads' pages if possible, or a null pointer if memory is
+   exhausted. */
+static struct thread *
+alloc_thread_page (void) 
+{
+  struct thread *t = NULL;
+  enum intr_level old_level = intr_disable ();
+
+  if (thread_cache_cnt > 0)
+    t = thread_cache[--thread_cache_cnt];
+  intr_set_level (old_level);
+
+  if (t == NULL)
+    t = palloc_get_page (0);
+  return t;
+}
+
+/* Releases dead thread T's page, keeping it for reuse if the
+   cache has room.  Interrupts must be off. */
+static void
+free_thread_page (struct thread *t) 
+{
+  bool cached = false;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (thread_cache_cnt < THREAD_CACHE_MAX)
+    {
+      thread_cache[thread_cache_cnt++] = t;
+      cached = true;
     }
+
+  if (!cached)
+    palloc_free_page (t);
 }
 
 /* Schedules a new process.  At entry, interrupts must be off and
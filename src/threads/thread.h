@@ -3,9 +3,10 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rbtree.h>
 #include <stdint.h>
 #include "synch.h"
-#include "lib/kernel/hash.h"
+#include "devices/timer.h"
 #include "vm/page.h"
 
 /* States in a thread's life cycle. */
@@ -114,14 +115,19 @@ struct thread
     struct list_elem elem;              /* List element. */
 
     /* Priority donation */
-    struct list donators_list;
-    struct list_elem d_elem;
-    struct lock *wait_on_lock;
-    int original_priority;
+    struct list held_locks;             /* Locks held, for donations. */
+    struct rb_elem waiter_elem;         /* Element in a lock's waiters. */
+    struct lock *wait_on_lock;          /* Lock being waited for. */
+    int original_priority;              /* Priority before donations. */
 
     /* mlfqs variable */
     int nice;
     fp_t recent_cpu;
+    unsigned decay_epoch;               /* Seconds of decay applied. */
+
+    /* CFS. */
+    int64_t vruntime;                   /* Weighted run time. */
+    struct rb_elem rb_elem;             /* Element in a CFS run queue. */
 
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
@@ -134,17 +140,27 @@ struct thread
     struct PCB *pcb;
     bool child_load_success;
     struct file *executable;
+    void *user_esp;                     /* User stack pointer on entry
+                                           to the current system call. */
 #endif
 
     /* Owned by thread.c. */
     unsigned magic;                     /* Detects stack overflow. */
     
     /* Virtual Memory */
-    struct hash vm_table;
+    struct vm_table vm_table;           /* Supplemental page table. */
     struct list mmap_list;
-
-    /* wake up time used in priority scheduling*/
-    int64_t wakeup_time;
+    void *heap_start;                   /* First byte of the sbrk() heap. */
+    void *heap_end;                     /* Current program break. */
+    struct vm_area *heap_area;          /* Heap pages, NULL if none. */
+    void *fault_around_last;            /* Page of last file-backed fault. */
+    size_t fault_around_pages;          /* Current fault-around window. */
+    size_t rss;                         /* Frames owned, see vm/frame.c. */
+    size_t ws_target;                   /* Working-set target in frames. */
+    unsigned pf_cnt;                    /* Page faults this PFF interval. */
+
+    /* Wakes the thread from thread_sleep(). */
+    struct timer sleep_timer;
   };
 
 /* If false (default), use round-robin scheduler.
@@ -152,6 +168,11 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the completely fair scheduler, which runs the
+   ready thread with the least weighted run time.
+   Controlled by kernel command-line option "-cfs". */
+extern bool thread_cfs;
+
 void thread_init (void);
 void thread_start (void);
 
@@ -173,10 +194,10 @@ void thread_yield (void);
 
 // My preemption function
 void thread_preemption (void);
+void thread_change_priority (struct thread *, int priority);
 
 // My sleep list functions
 void thread_sleep (int64_t ticks);
-void thread_wakeup(const int64_t current_time);
 
 /* Performs some operation on thread t, given auxiliary data AUX. */
 typedef void thread_action_func (struct thread *t, void *aux);
@@ -184,11 +205,12 @@ void thread_foreach (thread_action_func *, void *);
 
 // My mlfqs functions
 int mlfqs_calculate_priority (fp_t recent_cpu, int nice);
-fp_t mlfqs_calculate_recent_cpu (fp_t recent_cpu, int nice);
+fp_t mlfqs_calculate_decay (void);
+fp_t mlfqs_calculate_recent_cpu (fp_t recent_cpu, fp_t decay, int nice);
 void update_load_avg (void);
 void increment_recent_cpu_on_every_tick (void);
-void mlfqs_set_priority_of_all_thread (void);
-void mlfqs_set_recent_cpu_of_all_thread (void);
+void mlfqs_set_priority_of_current_thread (void);
+void mlfqs_set_recent_cpu_of_ready_threads (void);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
@@ -199,8 +221,8 @@ int thread_get_recent_cpu (void);
 int thread_get_load_avg (void);
 
 // My helper function for sorting list with priority
-bool less_wakeup_time (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 bool set_list_to_priority_descending (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
+bool thread_vruntime_less (const struct rb_elem *a, const struct rb_elem *b, void *aux UNUSED);
 void update_current_thread_priority_with_donators(void);
 
 /* for parent-child relationship */
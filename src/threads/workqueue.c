@@ -0,0 +1,322 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* Workqueues.
+
+   Code that runs in an interrupt handler, or on a path whose
+   latency matters, can hand the rest of its job to a workqueue
+   instead of doing it inline: queue_work() puts a work item on
+   the queue and ups a semaphore, and one of the queue's worker
+   threads takes the item off and runs it.  queue_work() may be
+   called from an interrupt handler, so the queue is protected by
+   turning interrupts off rather than by a lock.
+
+   A work item is on at most one queue at a time.  Queuing it
+   again while it is pending does nothing, which lets an interrupt
+   handler queue the same item on every tick without piling up
+   copies.  It stops being pending just before its function
+   runs, so the function may queue it again, and may also free
+   it: a worker does not touch the item once the function has
+   started. */
+
+struct workqueue *system_wq;
+
+/* A thread waiting in workqueue_flush(). */
+struct flusher
+  {
+    struct list_elem elem;              /* Element in flushers list. */
+    struct semaphore done;              /* Upped when the queue drains. */
+  };
+
+static void worker (void *wq_);
+static void insert_work (struct workqueue *, struct work *);
+static void retire_work (struct workqueue *);
+static void delayed_work_timer (void *dw_);
+
+/* Creates the shared system workqueue.  Must be called after
+   thread_start(). */
+void
+workqueue_init (void)
+{
+  system_wq = workqueue_create ("events", 2, PRI_DEFAULT);
+  if (system_wq == NULL)
+    PANIC ("could not create system workqueue");
+}
+
+/* Creates a workqueue named NAME served by WORKER_CNT threads of
+   the given PRIORITY.  Returns the new queue, or a null pointer
+   if memory or threads could not be had.  Workqueues live until
+   the kernel shuts down. */
+struct workqueue *
+workqueue_create (const char *name, int worker_cnt, int priority)
+{
+  struct workqueue *wq;
+  int i;
+
+  ASSERT (name != NULL);
+  ASSERT (worker_cnt > 0);
+
+  wq = malloc (sizeof *wq);
+  if (wq == NULL)
+    return NULL;
+
+  wq->name = name;
+  list_init (&wq->queue);
+  sema_init (&wq->items, 0);
+  wq->outstanding = 0;
+  list_init (&wq->flushers);
+  wq->worker_cnt = 0;
+
+  for (i = 0; i < worker_cnt; i++)
+    {
+      char worker_name[16];
+
+      snprintf (worker_name, sizeof worker_name, "%s/%d", name, i);
+      if (thread_create (worker_name, priority, worker, wq) == TID_ERROR)
+        break;
+      wq->worker_cnt++;
+    }
+
+  /* Workers never exit, so a queue that got some of its workers
+     has to be kept with what it got. */
+  if (wq->worker_cnt == 0)
+    {
+      free (wq);
+      return NULL;
+    }
+  return wq;
+}
+
+/* Waits until WQ has no work queued or running, including work
+   queued after this call.  Must not be called from one of WQ's
+   own work functions, which would wait on itself. */
+void
+workqueue_flush (struct workqueue *wq)
+{
+  struct flusher f;
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  sema_init (&f.done, 0);
+  old_level = intr_disable ();
+  if (wq->outstanding == 0)
+    {
+      intr_set_level (old_level);
+      return;
+    }
+  list_push_back (&wq->flushers, &f.elem);
+  intr_set_level (old_level);
+
+  sema_down (&f.done);
+}
+
+/* Initializes W to call FUNC(AUX) when it runs. */
+void
+work_init (struct work *w, work_func *func, void *aux)
+{
+  ASSERT (func != NULL);
+
+  w->func = func;
+  w->aux = aux;
+  w->wq = NULL;
+  w->pending = false;
+}
+
+/* Queues W on WQ.  Returns true if successful, false if W was
+   already pending.  May be called from an interrupt handler. */
+bool
+queue_work (struct workqueue *wq, struct work *w)
+{
+  enum intr_level old_level;
+
+  ASSERT (wq != NULL);
+
+  old_level = intr_disable ();
+  if (w->pending)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  w->pending = true;
+  w->wq = wq;
+  insert_work (wq, w);
+  intr_set_level (old_level);
+
+  sema_up (&wq->items);
+  return true;
+}
+
+/* Takes W off its queue if it has not started running yet.
+   Returns true if W was pending, false otherwise.  W may still
+   be running when this returns false.  Delayed work must be
+   cancelled with cancel_delayed_work() instead. */
+bool
+cancel_work (struct work *w)
+{
+  struct workqueue *wq = w->wq;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  if (!w->pending)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  list_remove (&w->elem);
+  w->pending = false;
+  intr_set_level (old_level);
+
+  /* WQ's semaphore is now one ahead of its queue.  The worker
+     that consumes the extra up finds the queue empty and goes
+     back to waiting. */
+  retire_work (wq);
+  return true;
+}
+
+/* Returns true if W is queued, or waiting on its timer, and has
+   not started running. */
+bool
+work_pending (const struct work *w)
+{
+  return w->pending;
+}
+
+/* Initializes DW to call FUNC(AUX) when it runs. */
+void
+delayed_work_init (struct delayed_work *dw, work_func *func, void *aux)
+{
+  work_init (&dw->work, func, aux);
+  timer_setup (&dw->timer, delayed_work_timer, dw);
+}
+
+/* Queues DW on WQ once TICKS timer ticks have passed, or at
+   once if TICKS <= 0.  Returns true if successful, false if DW
+   was already pending.  May be called from an interrupt
+   handler. */
+bool
+queue_delayed_work (struct workqueue *wq, struct delayed_work *dw,
+                    int64_t ticks)
+{
+  enum intr_level old_level;
+
+  ASSERT (wq != NULL);
+
+  if (ticks <= 0)
+    return queue_work (wq, &dw->work);
+
+  old_level = intr_disable ();
+  if (dw->work.pending)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  dw->work.pending = true;
+  dw->work.wq = wq;
+  timer_add (&dw->timer, timer_ticks () + ticks);
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Stops DW from running if it has not started yet, whether its
+   timer is still pending or it is already on its queue.
+   Returns true if DW was pending, false otherwise. */
+bool
+cancel_delayed_work (struct delayed_work *dw)
+{
+  enum intr_level old_level;
+  bool cancelled;
+
+  old_level = intr_disable ();
+  if (timer_cancel (&dw->timer))
+    {
+      dw->work.pending = false;
+      cancelled = true;
+    }
+  else
+    cancelled = cancel_work (&dw->work);
+  intr_set_level (old_level);
+  return cancelled;
+}
+
+/* Worker thread: runs work from WQ_ forever. */
+static void
+worker (void *wq_)
+{
+  struct workqueue *wq = wq_;
+
+  for (;;)
+    {
+      struct work *w;
+      work_func *func;
+      void *aux;
+      enum intr_level old_level;
+
+      sema_down (&wq->items);
+
+      old_level = intr_disable ();
+      if (list_empty (&wq->queue))
+        {
+          /* Cancelled before we got to it. */
+          intr_set_level (old_level);
+          continue;
+        }
+      w = list_entry (list_pop_front (&wq->queue), struct work, elem);
+      w->pending = false;
+      func = w->func;
+      aux = w->aux;
+      intr_set_level (old_level);
+
+      func (aux);
+      retire_work (wq);
+    }
+}
+
+/* Adds W to the end of WQ's queue.  Interrupts must be off. */
+static void
+insert_work (struct workqueue *wq, struct work *w)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  list_push_back (&wq->queue, &w->elem);
+  wq->outstanding++;
+}
+
+/* Notes that a work item of WQ has finished or been cancelled,
+   and wakes up flushers if it was the last one. */
+static void
+retire_work (struct workqueue *wq)
+{
+  struct list done;
+  enum intr_level old_level;
+
+  list_init (&done);
+  old_level = intr_disable ();
+  ASSERT (wq->outstanding > 0);
+  if (--wq->outstanding == 0)
+    while (!list_empty (&wq->flushers))
+      list_push_back (&done, list_pop_front (&wq->flushers));
+  intr_set_level (old_level);
+
+  /* sema_up() may yield, so it is called with interrupts back on. */
+  while (!list_empty (&done))
+    {
+      struct flusher *f = list_entry (list_pop_front (&done),
+                                      struct flusher, elem);
+      sema_up (&f->done);
+    }
+}
+
+/* Timer callback for delayed work: queues DW_. */
+static void
+delayed_work_timer (void *dw_)
+{
+  struct delayed_work *dw = dw_;
+
+  insert_work (dw->work.wq, &dw->work);
+  sema_up (&dw->work.wq->items);
+}
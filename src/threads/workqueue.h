@@ -0,0 +1,61 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/timer.h"
+#include "threads/synch.h"
+
+/* A function run by a workqueue's worker thread.  Unlike a timer
+   callback it runs in an ordinary kernel thread, so it may sleep
+   and take locks. */
+typedef void work_func (void *aux);
+
+/* An item of deferred work. */
+struct work
+  {
+    work_func *func;                    /* Function to run. */
+    void *aux;                          /* Argument to FUNC. */
+    struct workqueue *wq;               /* Queue it was last queued on. */
+    bool pending;                       /* Queued but not yet started? */
+    struct list_elem elem;              /* Element in workqueue's list. */
+  };
+
+/* Work that is queued once a timer expires. */
+struct delayed_work
+  {
+    struct work work;                   /* The work itself. */
+    struct timer timer;                 /* Queues WORK when it fires. */
+  };
+
+/* A queue of work served by a pool of worker threads. */
+struct workqueue
+  {
+    const char *name;                   /* Name, for worker threads. */
+    struct list queue;                  /* Pending work, oldest first. */
+    struct semaphore items;             /* Upped once per queued work. */
+    unsigned outstanding;               /* Work queued or running. */
+    struct list flushers;               /* Threads in workqueue_flush(). */
+    int worker_cnt;                     /* Number of worker threads. */
+  };
+
+/* Shared queue for short work that doesn't need its own. */
+extern struct workqueue *system_wq;
+
+void workqueue_init (void);
+struct workqueue *workqueue_create (const char *name, int worker_cnt,
+                                    int priority);
+void workqueue_flush (struct workqueue *);
+
+void work_init (struct work *, work_func *, void *aux);
+bool queue_work (struct workqueue *, struct work *);
+bool cancel_work (struct work *);
+bool work_pending (const struct work *);
+
+void delayed_work_init (struct delayed_work *, work_func *, void *aux);
+bool queue_delayed_work (struct workqueue *, struct delayed_work *,
+                         int64_t ticks);
+bool cancel_delayed_work (struct delayed_work *);
+
+#endif /* threads/workqueue.h */
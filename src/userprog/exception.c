@@ -7,12 +7,15 @@
 #include "threads/vaddr.h"
 #include "userprog/process.h"
 #include "userprog/syscall.h"
+#include "userprog/usercopy.h"
 #include "vm/page.h"
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static bool resolve_fault (void *fault_addr, bool not_present, bool write,
+                           void *esp);
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -129,6 +132,7 @@ page_fault (struct intr_frame *f)
   bool write;        /* True: access was write, false: access was read. */
   bool user;         /* True: access by user, false: access by kernel. */
   void *fault_addr;  /* Fault address. */
+  void *esp;         /* User stack pointer. */
 
   /* Obtain faulting address, the virtual address that was
      accessed to cause the fault.  It may point to code or to
@@ -151,38 +155,38 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;          // 잘못된 write 연산으로 페이지 폴트났을 때 true
   user = (f->error_code & PF_U) != 0;           // 사용자 모드에서 실행된 이상한 코드 때문에 페이지 폴트 났을 때 true
 
-   if (not_present) {
-      struct vm_entry *vme = find_vme(fault_addr);
-      if (vme == NULL) {
-         if (!verify_stack ((int32_t) fault_addr, f->esp)){
-            // exit(-9999991);
-            exit(-1);
-         }
-         expand_stack (fault_addr);
-         return;
-      }
-      if (handle_mm_fault(vme) == false) {
-         // exit(-9999992);
-         exit(-1);
-      }
-   }
-
-   if(is_kernel_vaddr(fault_addr)/* || (write && user)*/){
-      // exit(-9999993);
-      exit(-1);
-   }
-
-   if (write) {
-      struct vm_entry *vme = find_vme(fault_addr);
-      if (vme == NULL) {
-         // exit(-9999994);
-         exit(-1);
-      }
-      if (vme->writable == false) {
-         // exit(-9999995);
-         exit(-1);
-      }
-   }
-
+  /* A kernel fault on a user address happens while a system call
+     copies user data: the stack pointer to check stack growth
+     against is the one the process trapped with. */
+  esp = user ? f->esp : thread_current ()->user_esp;
+  if (is_user_vaddr (fault_addr)
+      && resolve_fault (fault_addr, not_present, write, esp))
+    return;
+
+  /* A bad address.  If the kernel was copying from or to it, let
+     the copy fail instead, so that the system call can clean up. */
+  if (!user && usercopy_fixup (f))
+    return;
+  exit (-1);
 }
 
+/* Makes the access to user address FAULT_ADDR that faulted valid:
+   loads the page, grows the stack down to it, or gives the process
+   its own copy of a shared page.  ESP is the user stack pointer.
+   Returns false if the process may not access FAULT_ADDR this
+   way. */
+static bool
+resolve_fault (void *fault_addr, bool not_present, bool write, void *esp)
+{
+  struct vm_entry *vme = find_vme (fault_addr);
+
+  if (vme == NULL)
+    return not_present
+           && verify_stack ((int32_t) fault_addr, (int32_t) esp)
+           && expand_stack (fault_addr, write);
+  if (write && !vme->writable)
+    return false;
+  if (not_present)
+    return handle_mm_fault (vme, write);
+  return write && handle_wp_fault (vme);
+}
@@ -21,9 +21,11 @@
 #include "threads/malloc.h"
 #include "vm/page.h"
 #include "vm/swap.h"
+#include "vm/zswap.h"
 #include "vm/frame.h"
 
 static thread_func start_process NO_RETURN;
+static thread_func start_fork NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
 extern struct lock filesys_lock;
 
@@ -125,6 +127,108 @@ start_process (void *file_name_)
   NOT_REACHED ();
 }
 
+/* What a forking process hands to its child. */
+struct fork_args
+  {
+    struct thread *parent;              /* Forking process. */
+    struct intr_frame if_;              /* Parent's user context. */
+    bool success;                       /* Set by the child. */
+  };
+
+/* Creates a child process that is a copy of the current one and
+   resumes it from IF_, the user context of the fork() system call,
+   with 0 as the result.  Memory is shared copy-on-write.  Returns
+   the child's thread id, or TID_ERROR if it cannot be created. */
+tid_t
+process_fork (struct intr_frame *if_)
+{
+  struct fork_args args;
+  tid_t tid;
+
+  args.parent = thread_current ();
+  memcpy (&args.if_, if_, sizeof args.if_);
+  args.success = false;
+
+  tid = thread_create (args.parent->name, PRI_DEFAULT, start_fork, &args);
+  if (tid == TID_ERROR) {
+    return TID_ERROR;
+  }
+  /* Parent-child: wait until the address space is copied */
+  sema_down (&(get_child_thread(tid)->pcb->sema_wait_for_load));
+
+  return args.success ? tid : TID_ERROR;
+}
+
+/* Gives the current thread its own handles on PARENT's open
+   files, at the same positions. */
+static bool
+fork_files (struct thread *parent)
+{
+  struct thread *cur = thread_current ();
+  bool success = true;
+  int fd;
+
+  lock_acquire (&filesys_lock);
+  for (fd = 2; fd < parent->pcb->next_fd; fd++) {
+    struct file *f = parent->pcb->fdt[fd];
+    if (f != NULL) {
+      cur->pcb->fdt[fd] = file_reopen (f);
+      if (cur->pcb->fdt[fd] == NULL) {
+        success = false;
+        break;
+      }
+      file_seek (cur->pcb->fdt[fd], file_tell (f));
+    }
+  }
+  lock_release (&filesys_lock);
+  cur->pcb->next_fd = parent->pcb->next_fd;
+  cur->executable = parent->executable;
+  cur->heap_start = parent->heap_start;
+  cur->heap_end = parent->heap_end;
+  return success;
+}
+
+/* A thread function that turns the new thread into a copy of the
+   forking process and returns to user mode. */
+static void
+start_fork (void *args_)
+{
+  struct fork_args *args = args_;
+  struct thread *parent = args->parent;
+  struct thread *cur = thread_current ();
+  struct intr_frame if_;
+  bool success = false;
+
+  /* ARGS lives on the parent's stack, which goes away as soon as
+     the parent is woken up. */
+  memcpy (&if_, &args->if_, sizeof if_);
+
+  vm_init (&(cur->vm_table));
+  cur->pagedir = pagedir_create ();
+  if (cur->pagedir != NULL) {
+    process_activate ();
+    success = fork_files (parent)
+              && mmap_fork (parent)
+              && vm_fork (&(cur->vm_table), parent);
+    if (success && parent->heap_area != NULL) {
+      cur->heap_area = vma_find (&cur->vm_table, parent->heap_area->start);
+    }
+  }
+  cur->pcb->child_loaded = success;
+  args->success = success;
+
+  /* parent-child: after fork, signal */
+  sema_up (&(cur->pcb->sema_wait_for_load));
+  if (!success) {
+    thread_exit ();
+  }
+
+  /* fork() returns 0 in the child. */
+  if_.eax = 0;
+  asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
+  NOT_REACHED ();
+}
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -424,6 +528,9 @@ load (const char *file_name, void (**eip) (void), void **esp)
               if (!load_segment (file, file_page, (void *) mem_page,
                                  read_bytes, zero_bytes, writable))
                 goto done;
+              /* The heap starts after the last segment. */
+              if ((uint8_t *) t->heap_start < (uint8_t *) mem_page + read_bytes + zero_bytes)
+                t->heap_start = (uint8_t *) mem_page + read_bytes + zero_bytes;
             }
           else
             goto done;
@@ -437,6 +544,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
 
   /* Start address. */
   *eip = (void (*) (void)) ehdr.e_entry;
+  t->heap_end = t->heap_start;
 
   success = true;
   t->pcb->child_loaded = true;
@@ -452,6 +560,9 @@ load (const char *file_name, void (**eip) (void), void **esp)
 /* load() helpers. */
 
 static bool install_page (void *upage, void *kpage, bool writable);
+static void swap_readahead (struct vm_entry *vme, size_t swap_slot);
+static void fault_around (struct vm_entry *vme);
+static void drop_behind (struct vm_entry *vme);
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -520,60 +631,18 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
-  file_seek (file, ofs);
-  while (read_bytes > 0 || zero_bytes > 0) 
-    {
-      /* Calculate how to fill this page.
-         We will read PAGE_READ_BYTES bytes from FILE
-         and zero the final PAGE_ZERO_BYTES bytes. */
-      size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
-      size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-      // /* Get a page of memory. */
-      // uint8_t *kpage = palloc_get_page (PAL_USER);
-      // if (kpage == NULL)
-      //   return false;
-
-      // /* Load this page. */
-      // if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes)
-      //   {
-      //     palloc_free_page (kpage);
-      //     return false; 
-      //   }
-      // memset (kpage + page_read_bytes, 0, page_zero_bytes);
-
-      // /* Add the page to the process's address space. */
-      // if (!install_page (upage, kpage, writable)) 
-      //   {
-      //     palloc_free_page (kpage);
-      //     return false; 
-      //   }
-
-      struct file *_file = file_reopen(file);
-
-      struct vm_entry *vme = malloc(sizeof(struct vm_entry));
-      if (vme == NULL) {
-        return false;
-      }
-      memset (vme, 0, sizeof (struct vm_entry));
-      vme->type = VM_BIN;
-      vme->vaddr = upage;
-      vme->writable = writable;
-      vme->is_loaded = false;
-      vme->offset = ofs;
-      vme->read_bytes = page_read_bytes;
-      vme->zero_bytes = page_zero_bytes;
-      vme->swap_slot = 0;
-      vme->file = _file;
-      insert_vme(&(thread_current()->vm_table), vme);
-      // mmap_elem에 넣는 것도 필요함
-
-      /* Advance. */
-      read_bytes -= page_read_bytes;
-      zero_bytes -= page_zero_bytes;
-      ofs += page_read_bytes;
-      upage += PGSIZE;
-    }
+  /* The pages are described by a single area and read in on
+     first access; see find_vme(). */
+  struct file *_file = file_reopen(file);
+  if (_file == NULL) {
+    return false;
+  }
+  if (vma_create (&thread_current ()->vm_table, VM_BIN, upage,
+                  read_bytes + zero_bytes, _file, ofs, read_bytes,
+                  writable) == NULL) {
+    file_close (_file);
+    return false;
+  }
   return true;
 }
 
@@ -583,24 +652,18 @@ static bool
 setup_stack (void **esp) 
 {
   struct frame *kpage;
-  bool success = false;
+  struct vm_entry *vme;
 
   kpage = palloc_frame (PAL_USER | PAL_ZERO);
-  if (kpage != NULL) 
-    {
-      success = install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage->kaddr, true);
-      add_frame_to_frame_table(kpage);
-      if (success)
-        *esp = PHYS_BASE;
-      else
-        free_frame (kpage->kaddr);
-    }
-  
-  struct vm_entry *vme = malloc(sizeof(struct vm_entry));
+  if (kpage == NULL)
+    return false;
+  vme = slab_alloc (&vme_cache);
   if (vme == NULL) {
-    free_frame (kpage->kaddr);
+    palloc_free_page (kpage->kaddr);
+    slab_free (&frame_cache, kpage);
     return false;
   }
+  memset (vme, 0, sizeof (struct vm_entry));
   kpage->vme = vme;
   vme->type = VM_ANON;
   vme->vaddr = ((uint8_t *) PHYS_BASE) - PGSIZE;
@@ -611,8 +674,21 @@ setup_stack (void **esp)
   vme->zero_bytes = PGSIZE;
   vme->swap_slot = 0;
   vme->file = NULL;
-  insert_vme(&(thread_current()->vm_table), vme);
-  return success;
+
+  if (!install_page (vme->vaddr, kpage->kaddr, true)) {
+    palloc_free_page (kpage->kaddr);
+    slab_free (&frame_cache, kpage);
+    slab_free (&vme_cache, vme);
+    return false;
+  }
+  add_frame_to_frame_table(kpage);
+  if (!insert_vme(&(thread_current()->vm_table), vme)) {
+    free_frame (kpage->kaddr);
+    slab_free (&vme_cache, vme);
+    return false;
+  }
+  *esp = PHYS_BASE;
+  return true;
 }
 
 /* Adds a mapping from user virtual address UPAGE to kernel
@@ -635,102 +711,373 @@ install_page (void *upage, void *kpage, bool writable)
           && pagedir_set_page (t->pagedir, upage, kpage, writable));
 }
 
+/* Reads VME's page from its file into FRAME and maps it.  If the
+   page may be cached, another process may have cached it while we
+   waited for filesys_lock, in which case that frame is mapped
+   instead, FRAME is left unused and *SHARED is set to true.
+
+   A page we read ourselves is published in the page cache before
+   filesys_lock is released.  Otherwise a write() that came in
+   between would find no cached page and update only the disk, and
+   the page cache would then hold data older than the file. */
+static bool
+load_file_page (struct vm_entry *vme, struct frame *frame, bool *shared)
+{
+  bool was_holding_lock = lock_held_by_current_thread (&filesys_lock);
+  bool success;
+
+  if (!was_holding_lock)
+    lock_acquire (&filesys_lock);
+  *shared = vme_is_cacheable (vme) && frame_map_cached (vme);
+  success = (*shared
+             || (load_file (frame->kaddr, vme)
+                 && install_page (vme->vaddr, frame->kaddr, vme->writable)));
+  if (success && !*shared && vme_is_cacheable (vme)) {
+    frame_cache_insert (frame);
+  }
+  if (!was_holding_lock)
+    lock_release (&filesys_lock);
+  return success;
+}
+
 bool
-handle_mm_fault (struct vm_entry *vme)
+handle_mm_fault (struct vm_entry *vme, bool write)
 {
-  struct frame *new_frame = palloc_frame(PAL_USER);
-  new_frame->vme = vme;
+  bool shared;
+  size_t swap_slot = 0;
+  struct frame *new_frame;
 
-  if (new_frame == NULL) {
-    PANIC("frame이 무조건 할당 되었어야 한다");
+  thread_current ()->pf_cnt++;
+
+  /* Reading a page that is known to be all zeros: share the zero
+     frame read-only until the first write. */
+  if (!write && vme_is_zero_fill (vme)) {
+    if (!install_page (vme->vaddr, zero_frame, false)) {
+      return false;
+    }
+    vme->is_loaded = true;
+    return true;
   }
 
-  if (new_frame->kaddr == NULL) {
-    PANIC("lru에 의해 반드시 할당됐어야 함");
-    return false;
+  /* A file page some process already has in memory: read-only
+     code of a program that is running elsewhere, or a page of a
+     file that is mapped elsewhere. */
+  if (vme_is_cacheable (vme) && frame_map_cached (vme)) {
+    return true;
   }
 
-  bool was_holding_lock = lock_held_by_current_thread (&filesys_lock);
+  new_frame = palloc_frame(PAL_USER);
+  if (new_frame == NULL) {
+    return false;
+  }
+  new_frame->vme = vme;
 
   switch (vme->type) {
     case VM_BIN:
-      if (load_file(new_frame->kaddr, vme) == false) {
-        free_frame(new_frame->kaddr);
-        return false;
-      }
-      break;
     case VM_FILE:
-      if (!was_holding_lock)
-        lock_acquire (&filesys_lock);
-
-      if (load_file(new_frame->kaddr, vme) == false) {
-        free_frame(new_frame->kaddr);
-
-        if (!was_holding_lock)
-          lock_release (&filesys_lock);
-
-        return false;
+      if (!load_file_page (vme, new_frame, &shared) || shared) {
+        palloc_free_page (new_frame->kaddr);
+        slab_free (&frame_cache, new_frame);
+        return shared;
       }
-
-      if (!was_holding_lock)
-        lock_release (&filesys_lock);
-        
       break;
     case VM_ANON:
-      swap_in(vme->swap_slot, new_frame->kaddr);
+      if (zswap_load (vme, new_frame->kaddr)) {
+        break;
+      }
+      if (vme->swap_slot == 0) {
+        memset (new_frame->kaddr, 0, PGSIZE);
+        break;
+      }
+      swap_slot = vme->swap_slot;
+      swap_in(swap_slot, new_frame->kaddr);
+      vme->swap_slot = 0;
       break;
     // case VM_STACK:
     //   break;
     default:
-      free_frame(new_frame->kaddr);
+      palloc_free_page (new_frame->kaddr);
+      slab_free (&frame_cache, new_frame);
       return false;
   }
-  
-  if (install_page(vme->vaddr, new_frame->kaddr, vme->writable) == false) {
-    free_frame(new_frame->kaddr);
+
+  /* load_file_page() has already mapped file pages. */
+  if (vme->type == VM_ANON
+      && !install_page (vme->vaddr, new_frame->kaddr, vme->writable)) {
+    palloc_free_page (new_frame->kaddr);
+    slab_free (&frame_cache, new_frame);
     return false;
   }
-  
   add_frame_to_frame_table(new_frame);
   vme->is_loaded = true;
+
+  if (swap_slot != 0 && vme->advice != MADV_RANDOM) {
+    swap_readahead (vme, swap_slot);
+  }
+  if (vme->type == VM_BIN || vme->type == VM_FILE) {
+    fault_around (vme);
+  }
+  if (vme->advice == MADV_SEQUENTIAL) {
+    drop_behind (vme);
+  }
   return true;
 }
 
+/* Handles a write to a present but read-only page of VME, which
+   must be writable.  If the page is mapped to the shared zero
+   frame, gives it a private zeroed frame.  If it is shared
+   copy-on-write with a forked process, gives it a private copy, or
+   just makes it writable if the other side has already let go. */
 bool
-expand_stack(void *addr){
-  struct frame *expand_frame;
-  void *upage = pg_round_down (addr);
-  bool success = false;
+handle_wp_fault (struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  struct frame *new_frame;
+  void *kaddr;
 
-  expand_frame = palloc_frame (PAL_USER | PAL_ZERO);
-  if (expand_frame != NULL){
-    success = install_page(upage, expand_frame->kaddr, true);
-    add_frame_to_frame_table (expand_frame);
-    if(success){
-      struct vm_entry *vme = malloc(sizeof(struct vm_entry));
-      if(vme == NULL){
-        free_frame(expand_frame->kaddr);
-        success = false;
-      }
-      expand_frame->vme =vme;
-      memset(expand_frame->vme, 0, sizeof (struct vm_entry));
-
-      expand_frame->vme->type = VM_ANON;
-      expand_frame->vme->vaddr = upage;
-      expand_frame->vme->writable = true;
-      expand_frame->vme->is_loaded = true;
-      expand_frame->vme->offset = 0;
-      expand_frame->vme->read_bytes = 0;
-      expand_frame->vme->zero_bytes = PGSIZE;
-      expand_frame->vme->swap_slot = 0;
-      expand_frame->vme->file = NULL;
-      insert_vme (&thread_current ()->vm_table, expand_frame->vme);
+  ASSERT (vme->writable);
+
+  for (;;) {
+    kaddr = pagedir_get_page (cur->pagedir, vme->vaddr);
+    if (kaddr == NULL) {
+      /* Evicted since the fault was raised. */
+      return handle_mm_fault (vme, true);
+    }
+    if (kaddr == zero_frame) {
+      break;
+    }
+    if (frame_make_writable (vme, kaddr)) {
+      return true;
+    }
+    new_frame = palloc_frame (PAL_USER);
+    if (new_frame == NULL) {
+      return false;
     }
-    else{
-      free_frame(expand_frame->kaddr);
+    if (frame_copy_on_write (vme, kaddr, new_frame)) {
+      return true;
     }
+    /* Evicted while we were allocating: start over. */
+    palloc_free_page (new_frame->kaddr);
+    slab_free (&frame_cache, new_frame);
   }
-  return success;
+
+  new_frame = palloc_frame (PAL_USER | PAL_ZERO);
+  if (new_frame == NULL) {
+    return false;
+  }
+  new_frame->vme = vme;
+  pagedir_clear_page (cur->pagedir, vme->vaddr);
+  if (!install_page (vme->vaddr, new_frame->kaddr, true)) {
+    palloc_free_page (new_frame->kaddr);
+    slab_free (&frame_cache, new_frame);
+    vme->is_loaded = false;
+    return false;
+  }
+  add_frame_to_frame_table (new_frame);
+  return true;
+}
+
+/* Swap-in clustering.  VME has just been read back from SWAP_SLOT;
+   pages that follow it in the address space were usually evicted
+   right after it and so sit in the following slots.  Bring in up to
+   swap_readahead_window of them while they stay adjacent on disk.
+   They are mapped with the accessed bit clear, so the clock hand
+   reclaims them first if the guess turns out wrong.  Only free
+   frames are used: read-ahead never evicts. */
+static void
+swap_readahead (struct vm_entry *vme, size_t swap_slot)
+{
+  struct thread *cur = thread_current ();
+  size_t i;
+
+  for (i = 1; i <= swap_readahead_window; i++) {
+    uint8_t *upage = (uint8_t *) vme->vaddr + i * PGSIZE;
+    struct vm_entry *next;
+    struct frame *frame;
+
+    if (!is_user_vaddr (upage)) {
+      break;
+    }
+    next = peek_vme (upage);
+    if (next == NULL || next->type != VM_ANON || next->is_loaded
+        || next->swap_slot != swap_slot + i) {
+      break;
+    }
+
+    frame = try_palloc_frame (PAL_USER);
+    if (frame == NULL) {
+      break;
+    }
+    frame->vme = next;
+    swap_in (next->swap_slot, frame->kaddr);
+    next->swap_slot = 0;
+
+    if (!install_page (upage, frame->kaddr, next->writable)) {
+      palloc_free_page (frame->kaddr);
+      slab_free (&frame_cache, frame);
+      break;
+    }
+    pagedir_set_accessed (cur->pagedir, upage, false);
+    add_frame_to_frame_table (frame);
+    next->is_loaded = true;
+  }
+}
+
+/* Fault-around.  VME, a page of a file, has just been loaded;
+   map up to the current thread's window of the file pages that
+   follow it as well, so that a process walking through its code
+   or a mapped file takes one fault per window instead of one per
+   page.
+
+   The window adapts per thread: a fault that lands just past the
+   previous one (within the old window) means the access pattern is
+   sequential and doubles it, up to fault_around_window; any other
+   fault halves it, so random access soon stops paying for pages it
+   never touches.  madvise() overrides the guess: MADV_SEQUENTIAL
+   pages always get twice the maximum window, MADV_RANDOM pages
+   none. */
+static void
+fault_around (struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  uint8_t *last = cur->fault_around_last;
+  size_t window;
+  size_t i;
+
+  if (vme->advice == MADV_RANDOM) {
+    return;
+  }
+
+  if (last != NULL && (uint8_t *) vme->vaddr > last
+      && (uint8_t *) vme->vaddr <= last + (cur->fault_around_pages + 1) * PGSIZE) {
+    cur->fault_around_pages = cur->fault_around_pages == 0
+                              ? 1 : cur->fault_around_pages * 2;
+    if (cur->fault_around_pages > fault_around_window) {
+      cur->fault_around_pages = fault_around_window;
+    }
+  }
+  else if (last != NULL) {
+    cur->fault_around_pages /= 2;
+  }
+  cur->fault_around_last = vme->vaddr;
+
+  window = vme->advice == MADV_SEQUENTIAL
+           ? 2 * fault_around_window : cur->fault_around_pages;
+  for (i = 1; i <= window; i++) {
+    uint8_t *upage = (uint8_t *) vme->vaddr + i * PGSIZE;
+    struct vm_entry *next;
+
+    if (!is_user_vaddr (upage)) {
+      break;
+    }
+    next = find_vme (upage);
+    if (next == NULL || next->type != vme->type || next->is_loaded
+        || next->read_bytes == 0
+        || file_get_inode (next->file) != file_get_inode (vme->file)) {
+      break;
+    }
+    if (!prefetch_page (next)) {
+      break;
+    }
+  }
+}
+
+/* Drop-behind for MADV_SEQUENTIAL.  A sequential reader is done
+   with the pages well behind VME, so clear their accessed bits and
+   let the clock hand take them before anything else. */
+static void
+drop_behind (struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  size_t i;
+
+  for (i = 2 * fault_around_window + 1; i <= 4 * fault_around_window; i++) {
+    uint8_t *upage = (uint8_t *) vme->vaddr - i * PGSIZE;
+    struct vm_entry *prev;
+
+    if ((uintptr_t) vme->vaddr < i * PGSIZE) {
+      break;
+    }
+    prev = peek_vme (upage);
+    if (prev != NULL && prev->is_loaded && prev->advice == MADV_SEQUENTIAL) {
+      pagedir_set_accessed (cur->pagedir, upage, false);
+    }
+  }
+}
+
+/* Brings VME's page into memory ahead of use, if a frame is free:
+   speculative loads never evict.  The page is mapped with the
+   accessed bit clear, so the clock hand reclaims it first if it
+   goes unused.  Returns false if there was no free frame or the
+   page could not be read. */
+bool
+prefetch_page (struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  struct frame *frame;
+  bool shared = false;
+  bool success;
+
+  if (vme->is_loaded || vme_is_zero_fill (vme)) {
+    return true;
+  }
+  if (vme_is_cacheable (vme) && frame_map_cached (vme)) {
+    pagedir_set_accessed (cur->pagedir, vme->vaddr, false);
+    return true;
+  }
+
+  frame = try_palloc_frame (PAL_USER);
+  if (frame == NULL) {
+    return false;
+  }
+  frame->vme = vme;
+  switch (vme->type) {
+    case VM_BIN:
+    case VM_FILE:
+      success = load_file_page (vme, frame, &shared);
+      break;
+    case VM_ANON:
+      if (!zswap_load (vme, frame->kaddr)) {
+        swap_in (vme->swap_slot, frame->kaddr);
+        vme->swap_slot = 0;
+      }
+      success = install_page (vme->vaddr, frame->kaddr, vme->writable);
+      break;
+    default:
+      success = false;
+      break;
+  }
+  if (!success || shared) {
+    palloc_free_page (frame->kaddr);
+    slab_free (&frame_cache, frame);
+    if (shared) {
+      pagedir_set_accessed (cur->pagedir, vme->vaddr, false);
+    }
+    return shared;
+  }
+  pagedir_set_accessed (cur->pagedir, vme->vaddr, false);
+  add_frame_to_frame_table (frame);
+  vme->is_loaded = true;
+  return true;
+}
+
+/* Grows the stack down to the page containing ADDR.  The new page
+   is an untouched anonymous page, so a read maps the shared zero
+   frame and only a WRITE allocates memory for it. */
+bool
+expand_stack(void *addr, bool write){
+  struct vm_entry *vme;
+
+  vme = vme_create_anon (pg_round_down (addr));
+  if (vme == NULL) {
+    return false;
+  }
+
+  if (!handle_mm_fault (vme, write)) {
+    delete_vme (&thread_current ()->vm_table, vme);
+    return false;
+  }
+  return true;
 }
 
 bool
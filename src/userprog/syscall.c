@@ -1,26 +1,41 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <round.h>
+#include <string.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/synch.h"
+#include "threads/palloc.h"
+#include "threads/slab.h"
 #include "userprog/pagedir.h"
 #include "threads/vaddr.h"
 #include "devices/shutdown.h"
 #include "userprog/process.h"
+#include "userprog/usercopy.h"
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 #include "devices/input.h"
 #include "vm/page.h"
 #include "vm/frame.h"
 
-#define	USER_VADDR_BOTTOM ((void *) 0x08048000)
+/* The heap may not grow into the region reserved for the stack. */
+#define HEAP_LIMIT ((uint8_t *) PHYS_BASE - 8 * 1024 * 1024)
+
+/* Most pages munmap() writes back in one file_write_at(). */
+#define MMAP_RUN_PAGES 8
+
+/* Most pages of its buffer read() or write() pins at a time. */
+#define PIN_PAGES 16
 
 typedef int pid_t;
 
 /* prevent race condition */
 struct lock filesys_lock;
 
+/* Cache that struct mmap_files are allocated from. */
+static struct slab_cache mmap_file_cache;
+
 /* System Call Handler */
 static void syscall_handler (struct intr_frame *);
 
@@ -50,36 +65,127 @@ void
 syscall_init (void) 
 {
   lock_init(&filesys_lock);
+  slab_cache_init (&mmap_file_cache, "mmap_file", sizeof (struct mmap_file));
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
 }
 
-struct vm_entry *
-check_valid_address (void *addr, void* esp)
+/* Returns the word OFS bytes above the user stack pointer in F,
+   where the system call number and arguments are.  Terminates the
+   process if it cannot be read. */
+static uint32_t
+get_arg (struct intr_frame *f, size_t ofs)
+{
+  uint32_t arg;
+  if (!copy_from_user (&arg, (uint8_t *) f->esp + ofs, sizeof arg)) {
+    exit(-1);
+  }
+  return arg;
+}
+
+/* Copies the string at user address USTR into a new page, which the
+   caller must free with palloc_free_page().  Returns NULL if the
+   string does not fit in a page or no page is available, and
+   terminates the process if the string cannot be read. */
+static char *
+copy_in_string (const char *ustr)
 {
-  if (is_kernel_vaddr(addr) || addr < USER_VADDR_BOTTOM) {
+  char *kstr = palloc_get_page (0);
+  int length;
+
+  if (kstr == NULL) {
+    return NULL;
+  }
+  length = strncpy_from_user (kstr, ustr, PGSIZE);
+  if (length < 0) {
+    palloc_free_page (kstr);
     exit(-1);
+  }
+  if (length == PGSIZE) {
+    palloc_free_page (kstr);
     return NULL;
   }
-  struct vm_entry* vme;
-  vme = find_vme(addr);
-  if(vme == NULL){
-    if (!verify_stack ((int32_t) addr, (int32_t) esp)){
-      exit (-1);
+  return kstr;
+}
+
+/* Makes the page of the current process holding user address
+   UADDR resident, and writable if WRITE is true, and pins it.
+   Returns false if it cannot be accessed that way. */
+static bool
+pin_user_page (uint8_t *uaddr, bool write)
+{
+  uint32_t *pd = thread_current ()->pagedir;
+  void *upage = pg_round_down (uaddr);
+  struct vm_entry *vme;
+  uint8_t byte;
+
+  for (;;) {
+    /* Fault the page in.  Writing back the byte just read also
+       gives us our own copy of a page shared copy-on-write. */
+    if (!copy_from_user (&byte, uaddr, 1)
+        || (write && !copy_to_user (uaddr, &byte, 1))) {
+      return false;
+    }
+    vme = find_vme (upage);
+    if (vme == NULL) {
+      return false;
+    }
+    vme->pinned = true;
+    if (write ? pagedir_is_writable (pd, upage)
+              : pagedir_get_page (pd, upage) != NULL) {
+      return true;
+    }
+    /* Evicted between the access and the pin: try again. */
+    vme->pinned = false;
+  }
+}
+
+/* Unpins the user pages spanning SIZE bytes at UBUF. */
+static void
+unpin_user_buffer (const void *ubuf, size_t size)
+{
+  const uint8_t *upage;
+
+  for (upage = pg_round_down (ubuf); upage < (const uint8_t *) ubuf + size;
+       upage += PGSIZE) {
+    struct vm_entry *vme = peek_vme ((void *) upage);
+    if (vme != NULL) {
+      vme->pinned = false;
     }
-    expand_stack (addr); 
   }
-  return vme;
+}
+
+/* Pins the user pages spanning SIZE bytes at UBUF, writable ones if
+   WRITE is true, so that file_read() and file_write() can work on
+   the buffer itself: they run with filesys_lock held, where a bad
+   address could not be recovered from, and the kernel's own writes
+   ignore the writable bit of user pages, so a page shared
+   copy-on-write must be copied first.  Returns false, leaving
+   nothing pinned, if some byte cannot be accessed that way. */
+static bool
+pin_user_buffer (void *ubuf, size_t size, bool write)
+{
+  uint8_t *start = ubuf;
+  uint8_t *upage;
+
+  for (upage = pg_round_down (start); upage < start + size; upage += PGSIZE) {
+    if (!pin_user_page (upage > start ? upage : start, write)) {
+      if (upage > start) {
+        unpin_user_buffer (start, upage - start);
+      }
+      return false;
+    }
+  }
+  return true;
 }
 
 /* System call handler */
 static void
 syscall_handler (struct intr_frame *f UNUSED) 
 {
-  uint32_t vec_no = *(uint32_t *)(f->esp);
-  struct vm_entry *vme = check_valid_address(f->esp, f->esp);
-  if (vme == NULL) {
-    exit(-1);
-  }
+  uint32_t vec_no;
+
+  thread_current ()->user_esp = f->esp;
+  vec_no = get_arg(f, 0);
 
   /* each system call cases */
   switch (vec_no){
@@ -87,75 +193,58 @@ syscall_handler (struct intr_frame *f UNUSED)
       halt();
       break;
     case SYS_EXIT:
-      check_valid_address(f->esp + 4, f->esp);
-      exit(*(uint32_t *)(f->esp + 4));
+      exit(get_arg(f, 4));
       break;
     case SYS_EXEC:
-      check_valid_address(f->esp + 4, f->esp);
-      check_valid_string((void *)*(uint32_t *)(f->esp + 4), f->esp);
-      f->eax = exec((const char *)*(uint32_t *)(f->esp + 4));
+      f->eax = exec((const char *)get_arg(f, 4));
       break;
     case SYS_WAIT:
-      check_valid_address(f->esp + 4, f->esp);
-      f->eax = wait((pid_t)*(uint32_t *)(f->esp + 4));
+      f->eax = wait((pid_t)get_arg(f, 4));
       break;
     case SYS_CREATE:
-      check_valid_address(f->esp + 16, f->esp);
-      check_valid_address(f->esp + 20, f->esp);
-      check_valid_string((void *)*(uint32_t *)(f->esp + 4), f->esp);
-      bool is_created = create((const char *)*(uint32_t *)(f->esp + 16), (unsigned)*(uint32_t *)(f->esp + 20));
-      f->eax = is_created;
+      f->eax = create((const char *)get_arg(f, 16), (unsigned)get_arg(f, 20));
       break;
     case SYS_REMOVE:
-      check_valid_address(f->esp + 4, f->esp);
-      check_valid_string((void *)*(uint32_t *)(f->esp + 4), f->esp);
-      f->eax = remove((const char*)*(uint32_t *)(f->esp + 4));
+      f->eax = remove((const char*)get_arg(f, 4));
       break;
     case SYS_OPEN:
-      check_valid_address(f->esp + 4, f->esp);
-      check_valid_string((void *)*(uint32_t *)(f->esp + 4), f->esp);
-      int fd = open((const char*)*(uint32_t *)(f->esp + 4));
-      f->eax = fd;
+      f->eax = open((const char*)get_arg(f, 4));
       break;
     case SYS_FILESIZE:
-      check_valid_address(f->esp + 4, f->esp);
-      f->eax = filesize((int)*(uint32_t *)(f->esp + 4));
+      f->eax = filesize((int)get_arg(f, 4));
       break;
     case SYS_READ:
-      check_valid_address(f->esp + 20, f->esp);
-      check_valid_address(f->esp + 24, f->esp);
-      check_valid_address(f->esp + 28, f->esp);
-      check_valid_buffer((void *)*(uint32_t *)(f->esp + 24), (unsigned)*(uint32_t *)(f->esp + 28), f->esp, true);
-      f->eax = read((int)*(uint32_t *)(f->esp+20), (void *)*(uint32_t *)(f->esp + 24), (unsigned)*((uint32_t *)(f->esp + 28)));
+      f->eax = read((int)get_arg(f, 20), (void *)get_arg(f, 24), (unsigned)get_arg(f, 28));
       break;
     case SYS_WRITE:
-      check_valid_address(f->esp + 20, f->esp);
-      check_valid_address(f->esp + 24, f->esp);
-      check_valid_address(f->esp + 28, f->esp);
-      check_valid_buffer((void *)*(uint32_t *)(f->esp + 24), (unsigned)*(uint32_t *)(f->esp + 28), f->esp, false);
-      f->eax = write((int)*(uint32_t *)(f->esp+20), (void *)*(uint32_t *)(f->esp + 24), (unsigned)*((uint32_t *)(f->esp + 28)));
+      f->eax = write((int)get_arg(f, 20), (void *)get_arg(f, 24), (unsigned)get_arg(f, 28));
       break;
     case SYS_SEEK:
-      check_valid_address(f->esp + 16, f->esp);
-      check_valid_address(f->esp + 20, f->esp);
-      seek((int)*(uint32_t *)(f->esp + 16), (unsigned)*(uint32_t *)(f->esp + 20));
+      seek((int)get_arg(f, 16), (unsigned)get_arg(f, 20));
       break;
     case SYS_TELL:
-      check_valid_address(f->esp + 4, f->esp);
-      f->eax = tell((int)*(uint32_t *)(f->esp + 4));
+      f->eax = tell((int)get_arg(f, 4));
       break;
     case SYS_CLOSE:
-      check_valid_address(f->esp + 4, f->esp);
-      close((int)*(uint32_t *)(f->esp + 4));
+      close((int)get_arg(f, 4));
       break;
     case SYS_MMAP:
-      check_valid_address(f->esp + 16, f->esp);
-      check_valid_address(f->esp + 20, f->esp);
-      f->eax = mmap((int)*(uint32_t *)(f->esp + 16), (void *)*(uint32_t *)(f->esp + 20));
+      f->eax = mmap((int)get_arg(f, 16), (void *)get_arg(f, 20));
       break;
     case SYS_MUNMAP:
-      check_valid_address(f->esp + 4, f->esp);
-      munmap((int)*(uint32_t *)(f->esp + 4));
+      munmap((int)get_arg(f, 4));
+      break;
+    case SYS_FORK:
+      f->eax = process_fork(f);
+      break;
+    case SYS_MMAP_ANON:
+      f->eax = mmap_anon((void *)get_arg(f, 4), (size_t)get_arg(f, 8));
+      break;
+    case SYS_MADVISE:
+      f->eax = madvise((void *)get_arg(f, 4), (size_t)get_arg(f, 8), (int)get_arg(f, 12));
+      break;
+    case SYS_SBRK:
+      f->eax = (uint32_t) sbrk((intptr_t)get_arg(f, 4));
       break;
     default:
       printf("default\n");
@@ -181,7 +270,15 @@ void exit (int status) {
 
 /* exec system call */
 pid_t exec (const char *cmd_line) {
-  return process_execute(cmd_line);
+  char *kcmd_line = copy_in_string (cmd_line);
+  pid_t pid;
+
+  if (kcmd_line == NULL) {
+    return -1;
+  }
+  pid = process_execute(kcmd_line);
+  palloc_free_page (kcmd_line);
+  return pid;
 }
 
 /* wait system call */
@@ -191,39 +288,38 @@ int wait (pid_t pid) {
 
 /* file create system call */
 bool create (const char *file, unsigned initial_size) {
-
-  if (file == NULL) {
-    exit(-1);
+  char *kfile = copy_in_string (file);
+  if (kfile == NULL) {
+    return false;
   }
 
   bool lock_held = lock_held_by_current_thread(&filesys_lock);
   if (!lock_held) {
     lock_acquire (&filesys_lock);
   }
-  bool is_created = filesys_create(file, initial_size);
+  bool is_created = filesys_create(kfile, initial_size);
   lock_release (&filesys_lock);
+  palloc_free_page (kfile);
   return is_created;
 }
 
 /* file remove system call */
 bool remove (const char *file) {
-  // lock_acquire (&filesys_lock);
-  if (file == NULL) {
-    // lock_release (&filesys_lock);
-    exit(-1);
+  char *kfile = copy_in_string (file);
+  if (kfile == NULL) {
+    return false;
   }
-  // check_valid_address(file);
-  bool is_removed = filesys_remove(file);
-  // lock_release (&filesys_lock);
+  bool is_removed = filesys_remove(kfile);
+  palloc_free_page (kfile);
   return is_removed;
 }
 
 /* file open system call */
 int open (const char *file) {
-  if (file == NULL) {
-    exit(-1);
+  char *kfile = copy_in_string (file);
+  if (kfile == NULL) {
+    return -1;
   }
-  // check_valid_address(file);
   struct thread *cur;
 
   /* prevent race condition */
@@ -232,20 +328,22 @@ int open (const char *file) {
     lock_acquire (&filesys_lock);
   }
 
-  struct file *f = filesys_open(file);
+  struct file *f = filesys_open(kfile);
   if (f == NULL) {
     lock_release (&filesys_lock);
+    palloc_free_page (kfile);
     return -1;
   }
   else{
     cur = thread_current();
     /* denying writes to executables */
-    if(cur->executable && (strcmp (cur->name, file) == 0)){
+    if(cur->executable && (strcmp (cur->name, kfile) == 0)){
       file_deny_write(f);
     }
     cur->pcb->fdt[cur->pcb->next_fd] = f;
     cur->pcb->next_fd++;
     lock_release (&filesys_lock);
+    palloc_free_page (kfile);
     return cur->pcb->next_fd-1;
   }
 }
@@ -259,52 +357,99 @@ int filesize (int fd) {
   return file_length(f);
 }
 
-/* file read system call */
+/* file read system call.  The buffer is pinned up to PIN_PAGES
+   pages at a time and read into directly. */
 int read (int fd, void *buffer, unsigned size) {
-  // check_valid_address(buffer);
-  bool is_already_holded = lock_held_by_current_thread(&filesys_lock);
-  if (!is_already_holded) {
-    lock_acquire (&filesys_lock);
-  }
-  if (fd == 0) {
-    unsigned i;
-    uint8_t *local_buffer = (uint8_t *)buffer;
-    for (i = 0; i < size; i++) {
-      local_buffer[i] = input_getc();
+  struct file *f = NULL;
+  unsigned done = 0;
+
+  if (fd != 0) {
+    f = process_get_file(fd);
+    if (f == NULL) {
+      return -1;
     }
-    lock_release (&filesys_lock);
-    return size;
   }
-  struct file *f = process_get_file(fd);
-  if (f == NULL) {
+
+  while (done < size) {
+    uint8_t *ubuf = (uint8_t *) buffer + done;
+    unsigned chunk = PIN_PAGES * PGSIZE - pg_ofs (ubuf);
+    unsigned bytes;
+
+    if (chunk > size - done) {
+      chunk = size - done;
+    }
+    if (!pin_user_buffer (ubuf, chunk, true)) {
+      exit(-1);
+    }
+
+    bool is_already_holded = lock_held_by_current_thread(&filesys_lock);
+    if (!is_already_holded) {
+      lock_acquire (&filesys_lock);
+    }
+    if (f == NULL) {
+      for (bytes = 0; bytes < chunk; bytes++) {
+        ubuf[bytes] = input_getc();
+      }
+    }
+    else {
+      bytes = file_read(f, ubuf, chunk);
+    }
     lock_release (&filesys_lock);
-    return -1;
+    unpin_user_buffer (ubuf, chunk);
+
+    done += bytes;
+    if (bytes < chunk) {
+      break;
+    }
   }
-  off_t bytes = file_read(f, buffer, size);
-  lock_release (&filesys_lock);
-  return bytes;
+  return done;
 }
 
-/* file write system call */
+/* file write system call.  Like read(), works on the pinned user
+   buffer. */
 int write (int fd, const void *buffer, unsigned size) {
-  // check_valid_address(buffer);
-  bool lock_held = lock_held_by_current_thread(&filesys_lock);
-  if (!lock_held) {
-    lock_acquire (&filesys_lock);
-  }
-  if (fd == 1) {
-    putbuf(buffer, size);
-    lock_release (&filesys_lock);
-    return size;
+  struct file *f = NULL;
+  unsigned done = 0;
+
+  if (fd != 1) {
+    f = process_get_file(fd);
+    if (f == NULL) {
+      return -1;
+    }
   }
-  struct file *f = process_get_file(fd);
-  if (f == NULL) {
+
+  while (done < size) {
+    const uint8_t *ubuf = (const uint8_t *) buffer + done;
+    unsigned chunk = PIN_PAGES * PGSIZE - pg_ofs (ubuf);
+    unsigned bytes;
+
+    if (chunk > size - done) {
+      chunk = size - done;
+    }
+    if (!pin_user_buffer ((void *) ubuf, chunk, false)) {
+      exit(-1);
+    }
+
+    bool lock_held = lock_held_by_current_thread(&filesys_lock);
+    if (!lock_held) {
+      lock_acquire (&filesys_lock);
+    }
+    if (f == NULL) {
+      putbuf((const char *) ubuf, chunk);
+      bytes = chunk;
+    }
+    else {
+      bytes = file_write(f, ubuf, chunk);
+    }
     lock_release (&filesys_lock);
-    return -1;
+    unpin_user_buffer (ubuf, chunk);
+
+    done += bytes;
+    if (bytes < chunk) {
+      break;
+    }
   }
-  off_t bytes = file_write(f, buffer, size);
-  lock_release (&filesys_lock);
-  return bytes;
+  return done;
 }
 
 /* file seek system call */
@@ -369,59 +514,240 @@ mapid_t
 mmap (int fd, void *addr)
 {
   struct mmap_file *mmap_file;
-  size_t offset = 0;
+  struct file *file;
   struct thread *cur = thread_current();
+  size_t length;
 
   if (is_user_vaddr(addr) == false || addr ==0 || pg_ofs(addr) != 0) {
     return -1;
   }
 
-  mmap_file = malloc(sizeof(struct mmap_file));
-  if (mmap_file == NULL) {
+  file = process_get_file(fd);
+  if(file == NULL){
+    return -1;
+  }
+  length = file_length (file);
+  if (length > (uintptr_t) PHYS_BASE - (uintptr_t) addr
+      || vm_range_in_use (&cur->vm_table, addr, (uint8_t *) addr + ROUND_UP (length, PGSIZE))) {
     return -1;
   }
 
+  mmap_file = slab_alloc (&mmap_file_cache);
+  if (mmap_file == NULL) {
+    return -1;
+  }
   memset(mmap_file, 0, sizeof(struct mmap_file));
-  list_init (&mmap_file->vme_list);
-  mmap_file->file = process_get_file(fd);
-  if(mmap_file->file == NULL){
+  mmap_file->file = file_reopen(file);
+  if (mmap_file->file == NULL) {
+    slab_free (&mmap_file_cache, mmap_file);
+    return -1;
+  }
+  mmap_file->area = vma_create (&cur->vm_table, VM_FILE, addr, length,
+                                mmap_file->file, 0, length, true);
+  if (mmap_file->area == NULL) {
+    file_close (mmap_file->file);
+    slab_free (&mmap_file_cache, mmap_file);
     return -1;
   }
-
-  mmap_file->file = file_reopen(mmap_file->file);
   mmap_file->map_id = cur->pcb->next_fd++;
   list_push_back (&cur->mmap_list, &mmap_file->elem);
 
-  int length = file_length (mmap_file -> file);
-  while (length > 0) {
-    if (find_vme (addr)) {
-      return -1;
+  return mmap_file->map_id;
+}
+
+/* fork() support: gives the current thread the same mappings as
+   PARENT.  File mappings go through the child's own handles on the
+   files; their pages are not copied: the child faults them in from
+   the page cache, so both processes see each other's stores, as
+   with any shared mapping.  The pages of anonymous mappings are
+   private, and vm_fork() shares them copy-on-write. */
+bool
+mmap_fork (struct thread *parent)
+{
+  struct list_elem *e;
+  struct thread *cur = thread_current();
+
+  for (e = list_begin (&parent->mmap_list); e != list_end (&parent->mmap_list); e = list_next (e)) {
+    struct mmap_file *parent_mf = list_entry (e, struct mmap_file, elem);
+    struct vm_area *parent_area = parent_mf->area;
+    struct mmap_file *mmap_file = slab_alloc (&mmap_file_cache);
+    if (mmap_file == NULL) {
+      return false;
+    }
+    memset (mmap_file, 0, sizeof (struct mmap_file));
+    mmap_file->map_id = parent_mf->map_id;
+    list_push_back (&cur->mmap_list, &mmap_file->elem);
+    if (parent_mf->file != NULL) {
+      mmap_file->file = file_reopen (parent_mf->file);
+      if (mmap_file->file == NULL) {
+        return false;
+      }
     }
-    
-    struct vm_entry *vme = malloc (sizeof(struct vm_entry));
-    memset (vme, 0, sizeof(struct vm_entry));
 
-    vme->type = VM_FILE;
-    vme->vaddr = addr;
-    vme->writable = true;
-    vme->is_loaded = false;
-    vme->offset = offset;
-    vme->read_bytes = length < PGSIZE ? length : PGSIZE;
-    vme->zero_bytes = 0;
-    vme->swap_slot = 0;
-    vme->file = mmap_file->file;
+    mmap_file->area = vma_create (&cur->vm_table, parent_area->type, parent_area->start,
+                                  (uint8_t *) parent_area->end - (uint8_t *) parent_area->start,
+                                  mmap_file->file, parent_area->offset,
+                                  parent_area->read_bytes, parent_area->writable);
+    if (mmap_file->area == NULL) {
+      return false;
+    }
+    mmap_file->area->advice = parent_area->advice;
+  }
+  return true;
+}
 
-    list_push_back(&mmap_file->vme_list, &vme->mmap_elem);
-    insert_vme(&cur->vm_table, vme);
+/* Anonymous mmap: maps LENGTH bytes of lazily zero-filled memory at
+   ADDR, which must be page-aligned.  The mapping is torn down with
+   munmap() like a file mapping, and is private to the process. */
+mapid_t
+mmap_anon (void *addr, size_t length)
+{
+  struct mmap_file *mmap_file;
+  struct thread *cur = thread_current();
+
+  if (is_user_vaddr(addr) == false || addr == 0 || pg_ofs(addr) != 0 || length == 0
+      || length > (uintptr_t) PHYS_BASE - (uintptr_t) addr
+      || vm_range_in_use (&cur->vm_table, addr, (uint8_t *) addr + ROUND_UP (length, PGSIZE))) {
+    return -1;
+  }
 
-    addr += PGSIZE;
-    offset += PGSIZE;
-    length -= PGSIZE;
+  mmap_file = slab_alloc (&mmap_file_cache);
+  if (mmap_file == NULL) {
+    return -1;
   }
+  memset(mmap_file, 0, sizeof(struct mmap_file));
+  mmap_file->file = NULL;
+  mmap_file->area = vma_create (&cur->vm_table, VM_ANON, addr, length,
+                                NULL, 0, 0, true);
+  if (mmap_file->area == NULL) {
+    slab_free (&mmap_file_cache, mmap_file);
+    return -1;
+  }
+  mmap_file->map_id = cur->pcb->next_fd++;
+  list_push_back (&cur->mmap_list, &mmap_file->elem);
 
   return mmap_file->map_id;
 }
 
+/* sbrk system call: moves the program break, the end of the heap
+   that starts right after the executable's segments, by INCREMENT
+   bytes.  Returns the old break, or (void *) -1 if the heap cannot
+   move that far.  The heap is a single VM_ANON area that grows and
+   shrinks with the break, so moving it costs the same however many
+   pages it spans; its pages are zero-filled on first touch and
+   released again when the break moves back below them. */
+void *
+sbrk (intptr_t increment)
+{
+  struct thread *cur = thread_current();
+  uint8_t *old_brk = cur->heap_end;
+  uint8_t *new_brk = old_brk + increment;
+  uint8_t *heap_page = pg_round_up (cur->heap_start);
+  uint8_t *old_end = pg_round_up (old_brk);
+  uint8_t *new_end = pg_round_up (new_brk);
+
+  if ((increment > 0 && (new_brk < old_brk || new_brk > HEAP_LIMIT))
+      || (increment < 0 && (new_brk > old_brk || new_brk < (uint8_t *) cur->heap_start))) {
+    return (void *) -1;
+  }
+
+  if (new_end > old_end) {
+    if (vm_range_in_use (&cur->vm_table, old_end, new_end)) {
+      return (void *) -1;
+    }
+    if (cur->heap_area == NULL) {
+      cur->heap_area = vma_create (&cur->vm_table, VM_ANON, heap_page,
+                                   new_end - heap_page, NULL, 0, 0, true);
+      if (cur->heap_area == NULL) {
+        return (void *) -1;
+      }
+    }
+    else {
+      vma_resize (&cur->vm_table, cur->heap_area, new_end);
+    }
+  }
+  else if (new_end < old_end) {
+    if (new_end == heap_page) {
+      vma_remove (&cur->vm_table, cur->heap_area);
+      cur->heap_area = NULL;
+    }
+    else {
+      vma_resize (&cur->vm_table, cur->heap_area, new_end);
+    }
+  }
+
+  cur->heap_end = new_brk;
+  return old_brk;
+}
+
+/* madvise system call: records ADVICE, one of the MADV_* values,
+   for the pages in [ADDR, ADDR + LENGTH), or acts on it right away.
+   MADV_WILLNEED reads the pages in, as far as free memory allows;
+   MADV_DONTNEED throws them away, writing mmap'd pages back to the
+   file first.  Pages that are not mapped are skipped.  Returns 0 if
+   successful, -1 if the arguments are bad. */
+int
+madvise (void *addr, size_t length, int advice)
+{
+  struct thread *cur = thread_current();
+  uint8_t *upage;
+  uint8_t *end = (uint8_t *) addr + length;
+
+  if (pg_ofs(addr) != 0 || end < (uint8_t *) addr || !is_user_vaddr(end - 1)
+      || advice < MADV_NORMAL || advice > MADV_DONTNEED) {
+    return -1;
+  }
+
+  for (upage = addr; upage < end; upage += PGSIZE) {
+    struct vm_area *area = vma_find (&cur->vm_table, upage);
+    struct vm_entry *vme;
+
+    if (advice == MADV_DONTNEED) {
+      /* Pages that were never used have nothing to throw away. */
+      vme = peek_vme (upage);
+    }
+    else if (advice != MADV_WILLNEED && area != NULL
+             && (uint8_t *) area->start >= (uint8_t *) addr
+             && (uint8_t *) area->end <= end) {
+      /* The whole area is covered: note the hint there, for pages
+         that have no entry yet. */
+      area->advice = advice;
+      vme = peek_vme (upage);
+    }
+    else {
+      vme = find_vme (upage);
+    }
+    if (vme == NULL) {
+      continue;
+    }
+    switch (advice) {
+      case MADV_WILLNEED:
+        if (!prefetch_page (vme)) {
+          return 0;
+        }
+        break;
+      case MADV_DONTNEED:
+        if (vme->type == VM_FILE && vme->is_loaded
+            && pagedir_is_dirty(cur->pagedir, vme->vaddr)) {
+          bool lock_held = lock_held_by_current_thread(&filesys_lock);
+          if (!lock_held) {
+            lock_acquire (&filesys_lock);
+          }
+          frame_write_back (vme);
+          if (!lock_held) {
+            lock_release (&filesys_lock);
+          }
+        }
+        vme_discard (vme);
+        break;
+      default:
+        vme->advice = advice;
+        break;
+    }
+  }
+  return 0;
+}
+
 void
 munmap (mapid_t mapping)
 {
@@ -451,36 +777,77 @@ munmap (mapid_t mapping)
   do_munmap(mmap_file);
 }
 
-void
-do_munmap(struct mmap_file *mmap_file)
+/* Writes the dirty pages of MMAP_FILE back to the file.  Clean
+   pages are identical to the file and are skipped; runs of
+   adjacent dirty pages are gathered into a kernel bounce buffer of
+   up to MMAP_RUN_PAGES pages and go out in a single write.  The
+   user pages themselves are never handed to the file system: one
+   could be evicted, and fault, while filesys_lock is held. */
+static void
+mmap_write_back (struct mmap_file *mmap_file)
 {
-  struct list_elem *e;
   struct thread *cur = thread_current();
-  void *addr;
+  struct vm_area *area = mmap_file->area;
+  struct vm_entry *run = NULL;
+  size_t run_bytes = 0;
+  size_t run_max = MMAP_RUN_PAGES;
+  uint8_t *bounce;
+  uint8_t *upage;
+  bool lock_held = lock_held_by_current_thread(&filesys_lock);
 
-  for (e = list_begin (&mmap_file->vme_list); e != list_end (&mmap_file->vme_list);/*list_next(e)*/) {
-    struct vm_entry *vme = list_entry (e, struct vm_entry, mmap_elem);
-    struct list_elem *temp;
+  bounce = palloc_get_multiple (0, run_max);
+  if (bounce == NULL) {
+    run_max = 1;
+    bounce = palloc_get_page (0);
+  }
 
-    if (vme->is_loaded == true) {
-      addr = pagedir_get_page(cur->pagedir, vme->vaddr);
+  if (!lock_held) {
+    lock_acquire (&filesys_lock);
+  }
+  for (upage = area->start; upage < (uint8_t *) area->end; upage += PGSIZE) {
+    struct vm_entry *vme = peek_vme (upage);
+    bool dirty = vme != NULL && vme->type == VM_FILE && vme->is_loaded
+                 && pagedir_is_dirty(cur->pagedir, vme->vaddr);
 
-      if (pagedir_is_dirty(cur->pagedir, vme->vaddr) == true) {
-        bool lock_held = lock_held_by_current_thread(&filesys_lock);
-        if (!lock_held) {
-          lock_acquire (&filesys_lock);
-        }
-        file_write_at(vme->file, vme->vaddr, vme->read_bytes, vme->offset);
-        lock_release(&filesys_lock);
-      }
-      free_frame(addr);
+    if (dirty && bounce == NULL) {
+      /* No memory for a bounce buffer: write from the frame. */
+      frame_write_back (vme);
+      continue;
+    }
+    if (run != NULL && dirty
+        && run_bytes < run_max * PGSIZE
+        && vme->vaddr == (uint8_t *) run->vaddr + run_bytes
+        && vme->offset == run->offset + (off_t) run_bytes
+        && frame_copy_out (vme, bounce + run_bytes)) {
+      run_bytes += vme->read_bytes;
+      continue;
+    }
+    if (run != NULL) {
+      file_write_at(run->file, bounce, run_bytes, run->offset);
+      run = NULL;
+    }
+    if (dirty && frame_copy_out (vme, bounce)) {
+      run = vme;
+      run_bytes = vme->read_bytes;
     }
-    // pagedir_clear_page(cur->pagedir, vme->vaddr);
-    vme->is_loaded = false;
-    e = list_remove(e);
-    delete_vme(&cur->vm_table, vme);
   }
+  if (run != NULL) {
+    file_write_at(run->file, bounce, run_bytes, run->offset);
+  }
+  if (!lock_held) {
+    lock_release (&filesys_lock);
+  }
+  palloc_free_multiple (bounce, run_max);
+}
+
+void
+do_munmap(struct mmap_file *mmap_file)
+{
+  struct thread *cur = thread_current();
+
+  mmap_write_back (mmap_file);
+  vma_remove (&cur->vm_table, mmap_file->area);
 
   list_remove (&mmap_file->elem);
-  free (mmap_file);
+  slab_free (&mmap_file_cache, mmap_file);
 }
\ No newline at end of file
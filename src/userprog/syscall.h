@@ -10,10 +10,12 @@ typedef int mapid_t;
 void syscall_init (void);
 void exit (int status);
 
-struct vm_entry *check_valid_address (void *addr, void* esp);
-
 mapid_t mmap (int fd, void *addr);
+mapid_t mmap_anon (void *addr, size_t length);
+void *sbrk (intptr_t increment);
+int madvise (void *addr, size_t length, int advice);
 void munmap(mapid_t mapping);
 void do_munmap(struct mmap_file *mmap_file);
+bool mmap_fork (struct thread *parent);
 
 #endif /* userprog/syscall.h */
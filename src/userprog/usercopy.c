@@ -0,0 +1,140 @@
+#include "userprog/usercopy.h"
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* Copying between kernel and user memory.
+
+   The routines below copy without looking at the user addresses
+   first, other than making sure they are below PHYS_BASE.  A page
+   that is not present faults, and the page-fault handler loads it
+   or grows the stack as it would for the process itself.  If the
+   address turns out to be bad, the handler calls usercopy_fixup(),
+   which moves the interrupted EIP to the copy's fixup address: the
+   copy stops there and reports failure to its caller, who can
+   release its locks before terminating the process.
+
+   Each copy is a short piece of assembly whose user accesses lie
+   between two global labels, so that the handler can tell a fault
+   in a copy from a kernel bug.  The functions must not be inlined,
+   or the labels would be defined more than once. */
+
+/* Labels defined in the assembly below. */
+extern const char usercopy_movs[], usercopy_movs_end[];
+extern const char usercopy_str[], usercopy_str_fault[];
+
+/* A range of instructions that access user memory, and where to
+   resume if one of them faults on a bad address. */
+struct usercopy_range
+  {
+    const char *start;          /* First instruction. */
+    const char *end;            /* End of the last instruction. */
+    const char *fixup;          /* Where to continue. */
+  };
+
+static const struct usercopy_range ranges[] =
+  {
+    { usercopy_movs, usercopy_movs_end, usercopy_movs_end },
+    { usercopy_str, usercopy_str_fault, usercopy_str_fault },
+  };
+
+/* Returns true if the SIZE bytes at UADDR are all user addresses. */
+static bool
+is_user_range (const void *uaddr, size_t size)
+{
+  return is_user_vaddr (uaddr)
+         && size <= (uintptr_t) PHYS_BASE - (uintptr_t) uaddr;
+}
+
+/* Copies SIZE bytes from SRC to DST.  Returns the number of bytes
+   left over, which is nonzero only if the copy faulted. */
+static size_t __attribute__ ((noinline, noclone))
+user_memcpy (void *dst, const void *src, size_t size)
+{
+  asm volatile (".globl usercopy_movs, usercopy_movs_end\n"
+                "usercopy_movs:\n\t"
+                "rep movsb\n"
+                "usercopy_movs_end:"
+                : "+D" (dst), "+S" (src), "+c" (size)
+                :
+                : "memory");
+  return size;
+}
+
+/* Copies SIZE bytes from user address USRC to DST.  Returns false
+   if any of the user bytes could not be read. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size)
+{
+  if (!is_user_range (usrc, size))
+    return false;
+  return user_memcpy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from SRC to user address UDST.  Returns false
+   if any of the user bytes could not be written. */
+bool
+copy_to_user (void *udst, const void *src, size_t size)
+{
+  if (!is_user_range (udst, size))
+    return false;
+  return user_memcpy (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into DST,
+   which has room for SIZE bytes.  Returns the length of the string,
+   SIZE if it does not fit, in which case DST is not terminated, or
+   -1 if it could not be read. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size)
+{
+  const char *src = usrc;
+  size_t left = size;
+  int faulted;
+
+  if (!is_user_vaddr (usrc))
+    return -1;
+  if (size > (uintptr_t) PHYS_BASE - (uintptr_t) usrc)
+    left = (uintptr_t) PHYS_BASE - (uintptr_t) usrc;
+
+  asm volatile (".globl usercopy_str, usercopy_str_fault\n\t"
+                "xorl %0, %0\n\t"
+                "jecxz 2f\n"
+                "usercopy_str:\n"
+                "1:\tlodsb\n\t"
+                "stosb\n\t"
+                "testb %%al, %%al\n\t"
+                "jz 2f\n\t"
+                "loop 1b\n\t"
+                "jmp 2f\n"
+                "usercopy_str_fault:\n\t"
+                "movl $1, %0\n"
+                "2:"
+                : "=&d" (faulted), "+D" (dst), "+S" (src), "+c" (left)
+                :
+                : "eax", "memory");
+
+  if (faulted)
+    return -1;
+  if (left == 0)
+    return (uintptr_t) PHYS_BASE - (uintptr_t) usrc < size ? -1 : (int) size;
+  return src - usrc - 1;
+}
+
+/* Called by the page-fault handler for a kernel fault on a bad
+   user address.  If F was interrupted in one of the copies above,
+   makes it resume at the copy's fixup address and returns true. */
+bool
+usercopy_fixup (struct intr_frame *f)
+{
+  const char *eip = (const char *) f->eip;
+  size_t i;
+
+  for (i = 0; i < sizeof ranges / sizeof *ranges; i++)
+    if (eip >= ranges[i].start && eip < ranges[i].end)
+      {
+        f->eip = (void (*) (void)) ranges[i].fixup;
+        return true;
+      }
+  return false;
+}
@@ -1,143 +1,899 @@
 #include <debug.h>
+#include <round.h>
+#include <string.h>
+#include "filesys/inode.h"
+#include "threads/interrupt.h"
 #include "threads/palloc.h"
+#include "threads/slab.h"
+#include "threads/vaddr.h"
+#include "threads/workqueue.h"
 #include "userprog/pagedir.h"
 #include "vm/frame.h"
 #include "vm/page.h"
 #include "vm/swap.h"
+#include "vm/zswap.h"
 
 struct list frame_table;
 struct lock ft_lock;
+static size_t frame_cnt;                /* Frames and table pages in use. */
+void *zero_frame;
+struct slab_cache frame_cache;
+static struct slab_cache sharer_cache;
+static struct work pff_work;            /* Runs pff_update(). */
+
+/* Page cache: frames holding file pages, keyed by (inode, page
+   offset).  Read-only executable pages are shared by processes
+   running the same program, and mmap'd pages by every process that
+   maps the file.  inode_read_at() and inode_write_at() go through
+   the cached frames too, so read(), write() and mmap see the same
+   data.  Only the first READ_BYTES bytes of a cached page come from
+   the file; the rest of the frame is zero fill.  Each inode counts
+   its cached pages, so that I/O to a file with none skips the cache.
+   Protected by ft_lock. */
+static struct hash page_cache;
+
+/* The frames in frame_table, keyed by KADDR, so that the frame
+   behind a mapping can be found without walking the table.
+   Protected by ft_lock. */
+static struct hash frame_index;
+
+static unsigned frame_index_hash (const struct hash_elem *e, void *aux UNUSED);
+static bool frame_index_less (const struct hash_elem *a,
+                              const struct hash_elem *b, void *aux UNUSED);
+static unsigned page_cache_hash (const struct hash_elem *e, void *aux UNUSED);
+static bool page_cache_less (const struct hash_elem *a,
+                             const struct hash_elem *b, void *aux UNUSED);
+static void frame_unmap_all (struct frame *frame);
+static void frame_unshare (struct frame *frame, struct thread *t);
+static bool frame_test_and_clear_accessed (struct frame *frame);
+static struct frame *frame_find (void *kaddr);
+static void frame_table_insert (struct frame *frame);
+static void pff_update (void *aux UNUSED);
+void _free_frame (struct frame *frame);
 
 void
 frame_table_init(void)
 {
   list_init(&frame_table);
-  lock_init(&ft_lock);
+  lock_init (&ft_lock);
+  hash_init (&frame_index, frame_index_hash, frame_index_less, NULL);
+  hash_init (&page_cache, page_cache_hash, page_cache_less, NULL);
+  zero_frame = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+  slab_cache_init (&frame_cache, "frame", sizeof (struct frame));
+  slab_cache_init (&sharer_cache, "frame_sharer", sizeof (struct frame_sharer));
+  work_init (&pff_work, pff_update, NULL);
+}
+
+static unsigned
+frame_index_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct frame *f = hash_entry (e, struct frame, fi_elem);
+  return hash_bytes (&f->kaddr, sizeof f->kaddr);
+}
+
+static bool
+frame_index_less (const struct hash_elem *a, const struct hash_elem *b,
+                  void *aux UNUSED)
+{
+  const struct frame *fa = hash_entry (a, struct frame, fi_elem);
+  const struct frame *fb = hash_entry (b, struct frame, fi_elem);
+  return fa->kaddr < fb->kaddr;
+}
+
+static unsigned
+page_cache_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct frame *f = hash_entry (e, struct frame, pc_elem);
+  return hash_bytes (&f->inode, sizeof f->inode) ^ hash_int (f->file_ofs);
+}
+
+static bool
+page_cache_less (const struct hash_elem *a, const struct hash_elem *b,
+                 void *aux UNUSED)
+{
+  const struct frame *fa = hash_entry (a, struct frame, pc_elem);
+  const struct frame *fb = hash_entry (b, struct frame, pc_elem);
+  if (fa->inode != fb->inode) {
+    return fa->inode < fb->inode;
+  }
+  return fa->file_ofs < fb->file_ofs;
+}
+
+/* Fills in the page cache key of a frame that will hold VME. */
+static void
+page_cache_key (struct frame *key, struct vm_entry *vme)
+{
+  key->inode = file_get_inode (vme->file);
+  key->file_ofs = vme->offset;
+  key->read_bytes = vme->read_bytes;
+}
+
+/* If VME's file page is already in the page cache, maps that frame
+   at VME's address in the current process and returns true.
+   Returns false if the page has to be loaded.  A cached page that
+   holds a different number of file bytes, say the last page of a
+   text segment mapped again with mmap(), cannot stand in for VME's
+   page, so VME gets a private copy. */
+bool
+frame_map_cached (struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  struct frame key, *frame;
+  struct frame_sharer *sharer;
+  struct hash_elem *e;
+  bool success = false;
+
+  ASSERT (vme_is_cacheable (vme));
+
+  sharer = slab_alloc (&sharer_cache);
+  if (sharer == NULL) {
+    return false;
+  }
+
+  page_cache_key (&key, vme);
+  lock_acquire (&ft_lock);
+  e = hash_find (&page_cache, &key.pc_elem);
+  if (e != NULL) {
+    frame = hash_entry (e, struct frame, pc_elem);
+    if (frame->read_bytes == vme->read_bytes
+        && pagedir_set_page (cur->pagedir, vme->vaddr, frame->kaddr,
+                          vme->writable)) {
+      sharer->thread = cur;
+      sharer->vme = vme;
+      list_push_back (&frame->sharers, &sharer->elem);
+      frame->ref_cnt++;
+      vme->is_loaded = true;
+      success = true;
+    }
+  }
+  lock_release (&ft_lock);
+
+  if (!success) {
+    slab_free (&sharer_cache, sharer);
+  }
+  return success;
+}
+
+/* Publishes FRAME, which holds a freshly loaded file page, for
+   other mappers and for file reads and writes.  filesys_lock must
+   be held from before the page was read until now, so that no
+   write() to the page can come in between.  If the same page is
+   somehow cached already, FRAME simply stays private. */
+void
+frame_cache_insert (struct frame *frame)
+{
+  lock_acquire (&ft_lock);
+  page_cache_key (frame, frame->vme);
+  if (hash_insert (&page_cache, &frame->pc_elem) != NULL) {
+    frame->inode = NULL;
+  }
+  else {
+    inode_add_cached_pages (frame->inode, 1);
+  }
+  lock_release (&ft_lock);
 }
 
 void
 add_frame_to_frame_table(struct frame *frame)
 {
-  lock_acquire(&ft_lock);
+  lock_acquire (&ft_lock);
+  frame_table_insert (frame);
+  lock_release (&ft_lock);
+}
+
+/* Adds FRAME to frame_table and frame_index.  ft_lock must be
+   held. */
+static void
+frame_table_insert (struct frame *frame)
+{
   list_push_back(&frame_table, &frame->ft_elem);
-  lock_release(&ft_lock);
+  hash_insert (&frame_index, &frame->fi_elem);
+  frame->owner_thread->rss++;
+  frame_cnt++;
 }
 
 void
 del_frame_from_frame_table(struct frame *frame)
 {
   list_remove(&frame->ft_elem);
+  hash_delete (&frame_index, &frame->fi_elem);
+  frame->owner_thread->rss--;
+  frame_cnt--;
+}
+
+/* Working-set control.
+
+   Frames are a single pool, so without some care a process that
+   streams through more memory than there is would take frames from
+   everyone.  Each process therefore has a working-set target, in
+   frames, that is adjusted from its page-fault frequency: a process
+   that faults often needs more frames than it has, and one that
+   hardly faults has more than it needs.  Eviction looks at the
+   frames of processes holding more than their target first (see
+   find_victim()), so a process that keeps its pages in use holds on
+   to them while a memory hog competes with itself.
+
+   The target grows by the number of faults taken, from at least the
+   current resident set, up to an equal share of the frames in use,
+   and shrinks by an eighth per quiet interval. */
+
+/* Adjusts T's working-set target from its recent fault count.
+   AUX points to the share of frames T may claim. */
+static void
+pff_update_thread (struct thread *t, void *aux)
+{
+  size_t share = *(size_t *) aux;
+
+  if (t->pagedir == NULL) {
+    return;
+  }
+  if (t->pf_cnt > PFF_HIGH) {
+    t->ws_target = (t->ws_target > t->rss ? t->ws_target : t->rss) + t->pf_cnt;
+  }
+  else if (t->pf_cnt < PFF_LOW) {
+    t->ws_target -= t->ws_target / 8;
+  }
+  if (t->ws_target > share) {
+    t->ws_target = share;
+  }
+  t->pf_cnt = 0;
+}
+
+/* Counts user processes. */
+static void
+pff_count_thread (struct thread *t, void *aux)
+{
+  if (t->pagedir != NULL) {
+    (*(size_t *) aux)++;
+  }
+}
+
+/* Called from the timer interrupt every PFF_INTERVAL ticks.
+   Walking every thread is too slow for the interrupt handler, so
+   the update is left to the system workqueue. */
+void
+frame_pff_update (void)
+{
+  queue_work (system_wq, &pff_work);
 }
 
+/* Recomputes every process's working-set target from the page
+   faults it took over the last PFF_INTERVAL ticks. */
+static void
+pff_update (void *aux UNUSED)
+{
+  size_t frames;
+  size_t proc_cnt = 0;
+  size_t share;
+  enum intr_level old_level;
+
+  lock_acquire (&ft_lock);
+  frames = frame_cnt;
+  lock_release (&ft_lock);
+
+  /* thread_foreach() needs interrupts off, so keep each walk to a
+     few loads and stores per thread. */
+  old_level = intr_disable ();
+  thread_foreach (pff_count_thread, &proc_cnt);
+  intr_set_level (old_level);
+  if (proc_cnt == 0) {
+    return;
+  }
+
+  share = frames / proc_cnt;
+  old_level = intr_disable ();
+  thread_foreach (pff_update_thread, &share);
+  intr_set_level (old_level);
+}
+
+/* Returns true if FRAME's owner holds more frames than its
+   working-set target. */
+static bool
+frame_over_target (const struct frame *frame)
+{
+  return frame->owner_thread->rss > frame->owner_thread->ws_target;
+}
+
+/* Allocates a frame for the current process, evicting one if the
+   user pool is empty.  Returns NULL if nothing can be evicted. */
 struct frame *
 palloc_frame (enum palloc_flags flags)
 {
   struct frame *frame;
-  frame = (struct frame *) malloc (sizeof (struct frame));
+  frame = slab_alloc (&frame_cache);
   if (frame == NULL){
     return NULL;
   }
-  lock_acquire(&ft_lock);
+  lock_acquire (&ft_lock);
 
   memset (frame, 0, sizeof (struct frame));
   frame->owner_thread = thread_current ();
+  frame->ref_cnt = 1;
+  list_init (&frame->sharers);
   frame->kaddr = palloc_get_page (flags);
 
   if (frame->kaddr == NULL) {
     frame->kaddr = lru_clock_algorithm(flags);
   }
+  lock_release (&ft_lock);
 
-  // add_frame_to_frame_table(frame);
   if (frame->kaddr == NULL) {
-    PANIC("frame->kaddr는 반드시 존재해야 함");
+    slab_free (&frame_cache, frame);
+    return NULL;
   }
-  if (frame->owner_thread == NULL) {
-    PANIC("frame->owner_thread는 반드시 존재해야 함");
+  ASSERT (frame->owner_thread->pagedir != NULL);
+  return frame;
+}
+
+/* Like palloc_frame(), but never evicts: returns NULL when no free
+   user page is left.  Used for speculative loads such as swap
+   read-ahead, which should only use memory that is lying idle. */
+struct frame *
+try_palloc_frame (enum palloc_flags flags)
+{
+  struct frame *frame;
+  void *kaddr = palloc_get_page (flags);
+  if (kaddr == NULL) {
+    return NULL;
   }
-  if (frame->owner_thread->pagedir == NULL) {
-    PANIC("frame->owner_thread는 반드시 존재해야 함");
+  frame = slab_alloc (&frame_cache);
+  if (frame == NULL) {
+    palloc_free_page (kaddr);
+    return NULL;
   }
-
-  lock_release(&ft_lock);
+  memset (frame, 0, sizeof (struct frame));
+  frame->owner_thread = thread_current ();
+  frame->ref_cnt = 1;
+  list_init (&frame->sharers);
+  frame->kaddr = kaddr;
   return frame;
 }
 
+/* Allocates a zeroed page from the user pool for a process's
+   supplemental page table, evicting a frame if the pool is empty.
+   Returns NULL if nothing can be evicted.  Taking these pages from
+   the user pool, rather than the kernel pool, makes the tables'
+   memory compete with user pages instead of limiting how many
+   processes can exist, so they count towards the process's resident
+   set and the frames in use like any other user page. */
+void *
+frame_alloc_table_page (void)
+{
+  bool was_holding_lock = lock_held_by_current_thread (&ft_lock);
+  void *kaddr;
+
+  if (!was_holding_lock)
+    lock_acquire (&ft_lock);
+  kaddr = palloc_get_page (PAL_USER | PAL_ZERO);
+  if (kaddr == NULL) {
+    kaddr = lru_clock_algorithm (PAL_USER | PAL_ZERO);
+  }
+  if (kaddr != NULL) {
+    thread_current ()->rss++;
+    frame_cnt++;
+  }
+  if (!was_holding_lock)
+    lock_release (&ft_lock);
+  return kaddr;
+}
+
+/* Frees KADDR, a page from frame_alloc_table_page(). */
+void
+frame_free_table_page (void *kaddr)
+{
+  bool was_holding_lock = lock_held_by_current_thread (&ft_lock);
+
+  if (!was_holding_lock)
+    lock_acquire (&ft_lock);
+  palloc_free_page (kaddr);
+  thread_current ()->rss--;
+  frame_cnt--;
+  if (!was_holding_lock)
+    lock_release (&ft_lock);
+}
+
+/* Looks up the cached frame holding the page of INODE that contains
+   byte OFFSET.  ft_lock must be held. */
+static struct frame *
+page_cache_find (struct inode *inode, off_t offset)
+{
+  struct frame key;
+  struct hash_elem *e;
+
+  key.inode = inode;
+  key.file_ofs = ROUND_DOWN (offset, PGSIZE);
+  e = hash_find (&page_cache, &key.pc_elem);
+  return e != NULL ? hash_entry (e, struct frame, pc_elem) : NULL;
+}
+
+/* Copies SIZE bytes at OFFSET in INODE into BUFFER from the page
+   cache.  The range must not cross a page boundary.  Returns false,
+   copying nothing, if the page is not cached or the range goes
+   past the file bytes the cached page holds.  BUFFER must be kernel
+   memory: touching user memory could fault and need ft_lock. */
+bool
+page_cache_read (struct inode *inode, off_t offset, void *buffer, size_t size)
+{
+  bool was_holding_lock = lock_held_by_current_thread (&ft_lock);
+  struct frame *frame;
+
+  ASSERT (pg_ofs ((void *) offset) + size <= PGSIZE);
+
+  if (!was_holding_lock)
+    lock_acquire (&ft_lock);
+  frame = page_cache_find (inode, offset);
+  if (frame != NULL && pg_ofs ((void *) offset) + size > frame->read_bytes) {
+    frame = NULL;
+  }
+  if (frame != NULL) {
+    memcpy (buffer, (uint8_t *) frame->kaddr + pg_ofs ((void *) offset), size);
+  }
+  if (!was_holding_lock)
+    lock_release (&ft_lock);
+  return frame != NULL;
+}
+
+/* Copies SIZE bytes from kernel BUFFER into the cached page of
+   INODE at OFFSET, if there is one, so that processes mapping the
+   file see data written with write().  Only the part of the range
+   within the file bytes the cached page holds is copied: the rest
+   of the frame is zero fill, not file data.  The range must not
+   cross a page boundary. */
+void
+page_cache_write (struct inode *inode, off_t offset, const void *buffer,
+                  size_t size)
+{
+  bool was_holding_lock = lock_held_by_current_thread (&ft_lock);
+  struct frame *frame;
+
+  ASSERT (pg_ofs ((void *) offset) + size <= PGSIZE);
+
+  if (!was_holding_lock)
+    lock_acquire (&ft_lock);
+  frame = page_cache_find (inode, offset);
+  if (frame != NULL && pg_ofs ((void *) offset) < frame->read_bytes) {
+    size_t ofs = pg_ofs ((void *) offset);
+    size_t n = size < frame->read_bytes - ofs ? size : frame->read_bytes - ofs;
+    memcpy ((uint8_t *) frame->kaddr + ofs, buffer, n);
+  }
+  if (!was_holding_lock)
+    lock_release (&ft_lock);
+}
+
+/* Copies the first VME->read_bytes bytes of the current thread's
+   resident page VME into kernel BUFFER.  Returns false, copying
+   nothing, if the page is not resident, in which case eviction has
+   already written it back if it was dirty. */
+bool
+frame_copy_out (struct vm_entry *vme, void *buffer)
+{
+  struct thread *cur = thread_current ();
+  void *kaddr;
+
+  lock_acquire (&ft_lock);
+  kaddr = vme->is_loaded ? pagedir_get_page (cur->pagedir, vme->vaddr) : NULL;
+  if (kaddr != NULL) {
+    memcpy (buffer, kaddr, vme->read_bytes);
+  }
+  lock_release (&ft_lock);
+  return kaddr != NULL;
+}
+
+/* Writes the current thread's resident file page VME back to its
+   file from the frame's kernel address.  Holding ft_lock keeps the
+   frame from being evicted while it is written, as in
+   lru_clock_algorithm().  Does nothing if the page is not
+   resident.  filesys_lock must be held. */
+void
+frame_write_back (struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  void *kaddr;
+
+  ASSERT (vme->type == VM_FILE);
+
+  lock_acquire (&ft_lock);
+  kaddr = vme->is_loaded ? pagedir_get_page (cur->pagedir, vme->vaddr) : NULL;
+  if (kaddr != NULL) {
+    file_write_at (vme->file, kaddr, vme->read_bytes, vme->offset);
+  }
+  lock_release (&ft_lock);
+}
+
+/* Returns true if any mapping of FRAME has been written to. */
+static bool
+frame_is_dirty (struct frame *frame)
+{
+  struct list_elem *e;
+
+  if (pagedir_is_dirty (frame->owner_thread->pagedir, frame->vme->vaddr)) {
+    return true;
+  }
+  for (e = list_begin (&frame->sharers); e != list_end (&frame->sharers);
+       e = list_next (e)) {
+    struct frame_sharer *s = list_entry (e, struct frame_sharer, elem);
+    if (pagedir_is_dirty (s->thread->pagedir, s->vme->vaddr)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Returns the frame whose page is at KADDR, or NULL.  ft_lock must
+   be held. */
+static struct frame *
+frame_find (void *kaddr)
+{
+  struct frame key;
+  struct hash_elem *e;
+
+  key.kaddr = kaddr;
+  e = hash_find (&frame_index, &key.fi_elem);
+  return e != NULL ? hash_entry (e, struct frame, fi_elem) : NULL;
+}
+
+/* Drops the current thread's mapping of the frame at KADDR.  The
+   frame itself is freed once nobody maps it any more. */
 void
 free_frame(void *kaddr)
 {
+  struct frame *frame;
+
+  lock_acquire (&ft_lock);
+  frame = frame_find (kaddr);
+  if (frame != NULL) {
+    if (frame->ref_cnt > 1) {
+      frame_unshare (frame, thread_current ());
+    }
+    else {
+      _free_frame(frame);
+    }
+  }
+  lock_release (&ft_lock);
+}
+
+/* fork() support.  Sets up VME, the current thread's copy of
+   PARENT's page PARENT_VME, to share whatever backs the parent's
+   page.  A resident page is mapped read-only in the child and, if
+   it is private, made read-only in the parent too, so that the
+   first write on either side copies it (see frame_copy_on_write()).
+   An evicted page gets its own copy of the compressed or swapped
+   data.  Returns false if out of memory. */
+bool
+frame_fork_page (struct thread *parent, struct vm_entry *parent_vme,
+                 struct vm_entry *vme)
+{
+  struct thread *cur = thread_current ();
+  struct frame_sharer *sharer;
   struct frame *frame = NULL;
+  void *kaddr = NULL;
+  bool success = true;
+
+  sharer = slab_alloc (&sharer_cache);
+  if (sharer == NULL) {
+    return false;
+  }
+
+  /* Eviction cannot move the parent's page while we look at it. */
+  lock_acquire (&ft_lock);
+  vme->is_loaded = false;
+  vme->zswap = NULL;
+  vme->swap_slot = 0;
+  if (parent_vme->is_loaded) {
+    kaddr = pagedir_get_page (parent->pagedir, parent_vme->vaddr);
+  }
+  if (kaddr != NULL && kaddr != zero_frame) {
+    frame = frame_find (kaddr);
+  }
+
+  if (kaddr == zero_frame) {
+    success = pagedir_set_page (cur->pagedir, vme->vaddr, zero_frame, false);
+    vme->is_loaded = success;
+  }
+  else if (frame != NULL) {
+    success = pagedir_set_page (cur->pagedir, vme->vaddr, kaddr, false);
+    if (success) {
+      if (!vme_is_cacheable (parent_vme)) {
+        pagedir_set_writable (parent->pagedir, parent_vme->vaddr, false);
+      }
+      sharer->thread = cur;
+      sharer->vme = vme;
+      list_push_back (&frame->sharers, &sharer->elem);
+      frame->ref_cnt++;
+      sharer = NULL;
+      vme->is_loaded = true;
+    }
+  }
+  else if (zswap_dup (parent_vme, vme)) {
+    success = vme->zswap != NULL || vme->swap_slot != 0;
+  }
+  else if (parent_vme->swap_slot != 0) {
+    vme->swap_slot = swap_dup (parent_vme->swap_slot);
+    success = vme->swap_slot != 0;
+  }
+  lock_release (&ft_lock);
+
+  slab_free (&sharer_cache, sharer);
+  return success;
+}
+
+/* Handles a write to the current thread's read-only mapping of the
+   frame at KADDR, which backs writable page VME.  If no other
+   process maps the frame any more, just makes the mapping writable
+   and returns true.  Returns false if the frame is still shared
+   and needs copying. */
+bool
+frame_make_writable (struct vm_entry *vme, void *kaddr)
+{
+  struct thread *cur = thread_current ();
+  struct frame *frame;
+  bool success = false;
+
+  lock_acquire (&ft_lock);
+  frame = frame_find (kaddr);
+  if (frame != NULL && frame->ref_cnt == 1
+      && pagedir_get_page (cur->pagedir, vme->vaddr) == kaddr) {
+    pagedir_set_writable (cur->pagedir, vme->vaddr, true);
+    success = true;
+  }
+  lock_release (&ft_lock);
+  return success;
+}
+
+/* Gives VME, which maps the shared frame at KADDR read-only, a
+   private writable copy of it in NEW_FRAME.  Returns false, leaving
+   NEW_FRAME to the caller, if the page was evicted while NEW_FRAME
+   was being allocated. */
+bool
+frame_copy_on_write (struct vm_entry *vme, void *kaddr,
+                     struct frame *new_frame)
+{
+  struct thread *cur = thread_current ();
+  struct frame *frame;
+
+  lock_acquire (&ft_lock);
+  frame = frame_find (kaddr);
+  if (frame == NULL || pagedir_get_page (cur->pagedir, vme->vaddr) != kaddr) {
+    lock_release (&ft_lock);
+    return false;
+  }
+
+  memcpy (new_frame->kaddr, kaddr, PGSIZE);
+  if (frame->ref_cnt > 1) {
+    frame_unshare (frame, cur);
+  }
+  else {
+    _free_frame (frame);
+  }
+  new_frame->vme = vme;
+  pagedir_set_page (cur->pagedir, vme->vaddr, new_frame->kaddr, true);
+  pagedir_set_dirty (cur->pagedir, vme->vaddr, true);
+  frame_table_insert (new_frame);
+  vme->is_loaded = true;
+  lock_release (&ft_lock);
+  return true;
+}
+
+/* Removes thread T's mapping from FRAME, which has other mappings
+   left.  If T was the first mapping, the oldest sharer takes its
+   place. */
+static void
+frame_unshare (struct frame *frame, struct thread *t)
+{
+  struct frame_sharer *sharer = NULL;
   struct list_elem *e;
 
-  lock_acquire(&ft_lock);
-  for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e)){
-    struct frame *temp_frame = list_entry (e, struct frame, ft_elem);
-    if (temp_frame->kaddr == kaddr){
-        _free_frame(temp_frame);
+  ASSERT (frame->ref_cnt > 1);
+
+  if (frame->owner_thread == t) {
+    pagedir_clear_page (t->pagedir, frame->vme->vaddr);
+    sharer = list_entry (list_pop_front (&frame->sharers),
+                         struct frame_sharer, elem);
+    frame->owner_thread->rss--;
+    frame->owner_thread = sharer->thread;
+    frame->owner_thread->rss++;
+    frame->vme = sharer->vme;
+  }
+  else {
+    for (e = list_begin (&frame->sharers); e != list_end (&frame->sharers);
+         e = list_next (e)) {
+      struct frame_sharer *s = list_entry (e, struct frame_sharer, elem);
+      if (s->thread == t) {
+        sharer = s;
+        list_remove (e);
         break;
+      }
     }
+    ASSERT (sharer != NULL);
+    pagedir_clear_page (t->pagedir, sharer->vme->vaddr);
   }
-  lock_release(&ft_lock);
+  slab_free (&sharer_cache, sharer);
+  frame->ref_cnt--;
 }
 
 void
 _free_frame(struct frame* frame)
 {
-  pagedir_clear_page (frame->owner_thread->pagedir, frame->vme->vaddr);
+  frame_unmap_all (frame);
+  if (frame->inode != NULL) {
+    hash_delete (&page_cache, &frame->pc_elem);
+    inode_add_cached_pages (frame->inode, -1);
+  }
   del_frame_from_frame_table(frame);
   palloc_free_page(frame->kaddr);
-  free(frame);
+  slab_free (&frame_cache, frame);
+}
+
+/* Clears every mapping of FRAME and marks the pages not loaded. */
+static void
+frame_unmap_all (struct frame *frame)
+{
+  pagedir_clear_page (frame->owner_thread->pagedir, frame->vme->vaddr);
+  while (!list_empty (&frame->sharers)) {
+    struct frame_sharer *sharer = list_entry (list_pop_front (&frame->sharers),
+                                              struct frame_sharer, elem);
+    pagedir_clear_page (sharer->thread->pagedir, sharer->vme->vaddr);
+    sharer->vme->is_loaded = false;
+    slab_free (&sharer_cache, sharer);
+  }
+  frame->ref_cnt = 1;
+}
+
+/* Returns true if any mapping of FRAME was accessed since the last
+   call, clearing the accessed bits as it goes. */
+static bool
+frame_test_and_clear_accessed (struct frame *frame)
+{
+  bool accessed = false;
+  struct list_elem *e;
+
+  if (pagedir_is_accessed (frame->owner_thread->pagedir, frame->vme->vaddr)) {
+    pagedir_set_accessed (frame->owner_thread->pagedir, frame->vme->vaddr, false);
+    accessed = true;
+  }
+  for (e = list_begin (&frame->sharers); e != list_end (&frame->sharers);
+       e = list_next (e)) {
+    struct frame_sharer *s = list_entry (e, struct frame_sharer, elem);
+    if (pagedir_is_accessed (s->thread->pagedir, s->vme->vaddr)) {
+      pagedir_set_accessed (s->thread->pagedir, s->vme->vaddr, false);
+      accessed = true;
+    }
+  }
+  return accessed;
+}
+
+/* Returns true if some mapping of FRAME is pinned by a system call
+   that is using it. */
+static bool
+frame_is_pinned (struct frame *frame)
+{
+  struct list_elem *e;
+
+  if (frame->vme->pinned) {
+    return true;
+  }
+  for (e = list_begin (&frame->sharers); e != list_end (&frame->sharers);
+       e = list_next (e)) {
+    if (list_entry (e, struct frame_sharer, elem)->vme->pinned) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Returns true if the page at KADDR holds only zeros. */
+static bool
+is_zero_page (const void *kaddr)
+{
+  const uint32_t *word = kaddr;
+  size_t i;
+
+  for (i = 0; i < PGSIZE / sizeof *word; i++) {
+    if (word[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Saves the contents of private page VME, held at KADDR, before its
+   frame is reclaimed.  A ZERO page needs nothing saved: a VM_ANON
+   page without a swap slot is recreated on the next fault. */
+static void
+evict_private (struct vm_entry *vme, void *kaddr, bool zero)
+{
+  if (zero) {
+    vme->swap_slot = 0;
+  }
+  else if (!zswap_store (vme, kaddr)) {
+    vme->swap_slot = swap_out(kaddr);
+    if (vme->swap_slot == 0) {
+      PANIC ("evict_private: out of swap space");
+    }
+  }
+  vme->type = VM_ANON;
 }
 
+/* Picks the frame to evict.  The first two sweeps only consider
+   frames of processes above their working-set target: the second
+   takes any whose accessed bit the first one cleared.  The next two
+   do the same for every frame.  Pinned frames are never taken.  Returns NULL if none of them finds a
+   victim, which happens when no frame can be evicted at all, or when
+   processes keep touching their pages faster than the sweeps clear
+   them. */
+#define VICTIM_SWEEPS 4
+
 static struct list_elem*
 find_victim(void) {
   struct list_elem *victim;
-  while (true) {
+  int sweep;
+  for (sweep = 0; sweep < VICTIM_SWEEPS; sweep++) {
     for (victim = list_begin(&frame_table); victim != list_end(&frame_table); victim = list_next(victim)) {
       struct frame *f = list_entry(victim, struct frame, ft_elem);
       if ((f->vme->type == VM_BIN || f->vme->type == VM_FILE || f->vme->type == VM_ANON) && f->owner_thread->pagedir != NULL) {
-        if (pagedir_is_accessed(f->owner_thread->pagedir, f->vme->vaddr)) {
-          pagedir_set_accessed(f->owner_thread->pagedir, f->vme->vaddr, false);
+        if ((sweep < 2 && !frame_over_target (f)) || frame_is_pinned (f)) {
+          continue;
         }
-        else {
+        if (!frame_test_and_clear_accessed (f)) {
           return victim;
         }
       }
-      else {
-        // PANIC("저거 말고 다른게 있나?");
-        // 저 세게 타입 말고 다른게 있는데 그게 뭔지는 잘 모르겠음
-      }
     }
   }
-  // ASSERT ("무조건 포문 안에서 찾아야되나?");
-  // 한 사이클 돌려서 안 찾아졌을 때, 찾아질 때까지 계속 돌려야 하는지는 잘 모르겠음
-  // victim으로 선정되는 페이지는 무조건 프로세스 data seg | stack에 포함되어에 하는 것 같음
   return NULL;
 }
 
+/* Evicts a frame and allocates a page with FLAGS in its place.
+   Returns NULL if there is no frame to evict.  ft_lock must be
+   held. */
 void*
 lru_clock_algorithm(enum palloc_flags flags) {
-  // lock_acquire(&ft_lock);
-  struct frame *victim_frame = list_entry(find_victim(), struct frame, ft_elem);
-  struct thread *victim_thread = victim_frame->owner_thread;
-  struct vm_entry *victim_vme = victim_frame->vme;
-
-  if (victim_vme->type == VM_BIN || victim_vme->type == VM_ANON) {
-    victim_vme->swap_slot = swap_out(victim_frame->kaddr);
-    if (victim_vme->type == VM_BIN){
-      victim_vme->type = VM_ANON;
+  struct list_elem *victim = find_victim ();
+  struct frame *victim_frame;
+  struct vm_entry *victim_vme;
+
+  if (victim == NULL) {
+    return NULL;
+  }
+  victim_frame = list_entry(victim, struct frame, ft_elem);
+  victim_vme = victim_frame->vme;
+
+  victim_vme->is_loaded = false;
+  if (victim_frame->inode != NULL) {
+    /* Out of the page cache first, so that the write-back below
+       does not find the frame it is writing from. */
+    hash_delete (&page_cache, &victim_frame->pc_elem);
+    inode_add_cached_pages (victim_frame->inode, -1);
+    victim_frame->inode = NULL;
+  }
+
+  if (victim_vme->type == VM_BIN && !victim_vme->writable) {
+    /* Read-only executable page: identical to the file, so every
+       sharer simply reloads or remaps it on its next fault. */
+  }
+  else if (victim_vme->type == VM_BIN || victim_vme->type == VM_ANON) {
+    /* Private page.  After fork() several processes may share it
+       copy-on-write; each of them keeps a copy of its own. */
+    bool zero = is_zero_page (victim_frame->kaddr);
+    struct list_elem *e;
+
+    evict_private (victim_vme, victim_frame->kaddr, zero);
+    for (e = list_begin (&victim_frame->sharers);
+         e != list_end (&victim_frame->sharers); e = list_next (e)) {
+      struct frame_sharer *s = list_entry (e, struct frame_sharer, elem);
+      evict_private (s->vme, victim_frame->kaddr, zero);
     }
   }
   else if (victim_vme->type == VM_FILE) {
-    if (pagedir_is_dirty(victim_thread->pagedir, victim_vme->vaddr)) {
-      victim_vme->swap_slot = swap_out(victim_vme);
+    /* A clean page is identical to the file and is simply read
+       back on the next fault.  Write from the kernel mapping: the
+       victim may belong to a process other than the one whose
+       page directory is active. */
+    if (frame_is_dirty (victim_frame)) {
+      file_write_at(victim_vme->file, victim_frame->kaddr, victim_vme->read_bytes, victim_vme->offset);
     }
-    file_write_at(victim_vme->file, victim_vme->vaddr, victim_vme->read_bytes, victim_vme->offset);
-  }
-  else {
-    // ASSERT("lru_clock_algorithm: victim_page->type is not VM_ANON or VM_FILE");
   }
 
   _free_frame(victim_frame);
-  // lock_release(&ft_lock);
   return palloc_get_page(flags);
 }
@@ -1,9 +1,12 @@
 #ifndef VM_FRAME_H
 #define VM_FRAME_H
 
+#include "devices/timer.h"
 #include "threads/thread.h"
 #include "lib/kernel/hash.h"
 #include "filesys/file.h"
+#include "threads/palloc.h"
+#include "threads/slab.h"
 #include "vm/page.h"
 
 struct frame {
@@ -11,13 +14,64 @@ struct frame {
     struct vm_entry *vme;               // 해당 페이지에 매핑되는 vm_entry를 가리키는 포인터
     struct thread *owner_thread;        // 해당 페이지를 사용하는 스레드를 가리키는 포인터
     struct list_elem ft_elem;           // frame table(LRU 리스트)에서 사용되는 list_elem 구조체
+    struct hash_elem fi_elem;           /* Element in frame_index. */
+
+    /* Sharing.  VME and OWNER_THREAD above are the first mapping;
+       any further mappings of the same frame are in SHARERS. */
+    int ref_cnt;                        /* Number of mappings. */
+    struct list sharers;                /* List of struct frame_sharer. */
+
+    /* Page cache key for file pages.  INODE is NULL if the frame
+       is not in the page cache. */
+    struct inode *inode;
+    off_t file_ofs;
+    size_t read_bytes;                  /* Bytes of file data held. */
+    struct hash_elem pc_elem;           /* Element in page_cache. */
+};
+
+/* An additional mapping of a shared frame. */
+struct frame_sharer {
+    struct thread *thread;
+    struct vm_entry *vme;
+    struct list_elem elem;
 };
 
+/* Read-only frame of zeros shared by every untouched zero page. */
+extern void *zero_frame;
+
+/* Cache that struct frames are allocated from. */
+extern struct slab_cache frame_cache;
+
+/* Page-fault-frequency working-set control: every PFF_INTERVAL
+   timer ticks, a process that took more than PFF_HIGH page faults
+   has its working-set target raised, and one that took fewer than
+   PFF_LOW has it lowered. */
+#define PFF_INTERVAL (TIMER_FREQ / 10)
+#define PFF_HIGH 8
+#define PFF_LOW 2
+
 void frame_table_init(void);
+void frame_pff_update (void);
 void add_frame_to_frame_table(struct frame *frame);
 void del_frame_from_frame_table(struct frame *frame);
 struct frame *palloc_frame (enum palloc_flags flags);
+struct frame *try_palloc_frame (enum palloc_flags flags);
+void *frame_alloc_table_page (void);
+void frame_free_table_page (void *kaddr);
 void free_frame(void *kaddr);
+bool frame_fork_page (struct thread *parent, struct vm_entry *parent_vme,
+                      struct vm_entry *vme);
+bool frame_make_writable (struct vm_entry *vme, void *kaddr);
+bool frame_copy_on_write (struct vm_entry *vme, void *kaddr,
+                          struct frame *new_frame);
+bool frame_map_cached (struct vm_entry *vme);
+void frame_cache_insert (struct frame *frame);
+bool frame_copy_out (struct vm_entry *vme, void *buffer);
+void frame_write_back (struct vm_entry *vme);
+bool page_cache_read (struct inode *inode, off_t offset, void *buffer,
+                      size_t size);
+void page_cache_write (struct inode *inode, off_t offset, const void *buffer,
+                       size_t size);
 void* lru_clock_algorithm(enum palloc_flags flags);
 
 #endif /* vm/frame.h */
\ No newline at end of file
@@ -1,61 +1,166 @@
 #include <debug.h>
+#include <round.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include "vm/page.h"
 #include "filesys/file.h"
-#include "lib/kernel/hash.h"
 #include "threads/thread.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/slab.h"
+#include "threads/pte.h"
 #include "threads/vaddr.h"
+#include "userprog/pagedir.h"
 #include "userprog/syscall.h"
+#include "vm/frame.h"
+#include "vm/swap.h"
+#include "vm/zswap.h"
 
-static unsigned vm_hash_func (const struct hash_elem *e, void *aux);
-static bool vm_less_func (const struct hash_elem *a, const struct hash_elem *b, void *aux);
+static void vme_release (struct vm_entry *vme);
 
 struct lock vm_lock;
+struct slab_cache vme_cache;
+size_t fault_around_window = FAULT_AROUND_DEFAULT;
 
+/* Supplemental page table.
+
+   A process's vm_entries live in a two-level radix tree laid out
+   like the x86 page directory (see threads/pte.h): the directory
+   is a page of leaf pointers indexed by pd_no(), and each leaf is a
+   page of vm_entry pointers indexed by pt_no().  Both levels are
+   allocated on first use and, as with page tables, a leaf stays
+   until the table is destroyed.  A lookup is two loads.  The pages
+   come from the user pool (see frame_alloc_table_page()), so a
+   process's table is paid for out of user memory.
+
+   Executable segments and mmap'd regions are recorded as areas
+   instead of one entry per page, so setting them up costs the same
+   however large they are.  find_vme() creates a page's entry from
+   its area the first time the page is looked up. */
+
+/* Only the directory entries below PHYS_BASE are ever used. */
+#define VM_DIR_CNT (pd_no (PHYS_BASE))
+#define VM_LEAF_CNT (1 << PTBITS)
+
+/* Initializes the state shared by all supplemental page tables. */
 void
-vm_init (struct hash *vm_table)
+page_init (void)
 {
-  bool success = hash_init(vm_table, vm_hash_func, vm_less_func, NULL);
   lock_init(&vm_lock);
-  if (!success) {
-    PANIC("vm_init failed 관련 invarient");
+  slab_cache_init (&vme_cache, "vm_entry", sizeof (struct vm_entry));
+}
+
+void
+vm_init (struct vm_table *vm)
+{
+  vm->dir = NULL;
+  list_init (&vm->areas);
+}
+
+/* Returns the slot for user page UPAGE in VM, or NULL if it has
+   none.  If CREATE is true, missing levels are allocated, and NULL
+   is returned only if that runs out of memory. */
+static struct vm_entry **
+vm_slot (struct vm_table *vm, const void *upage, bool create)
+{
+  struct vm_entry **leaf;
+
+  ASSERT (is_user_vaddr (upage));
+  ASSERT (pg_ofs (upage) == 0);
+
+  if (vm->dir == NULL) {
+    if (!create) {
+      return NULL;
+    }
+    vm->dir = frame_alloc_table_page ();
+    if (vm->dir == NULL) {
+      return NULL;
+    }
+  }
+  leaf = vm->dir[pd_no (upage)];
+  if (leaf == NULL) {
+    if (!create) {
+      return NULL;
+    }
+    leaf = frame_alloc_table_page ();
+    if (leaf == NULL) {
+      return NULL;
+    }
+    vm->dir[pd_no (upage)] = leaf;
   }
+  return &leaf[pt_no (upage)];
 }
 
-static unsigned
-vm_hash_func (const struct hash_elem *e, void *aux)
+/* Returns the entry for user page UPAGE in VM, or NULL. */
+static struct vm_entry *
+vm_lookup (struct vm_table *vm, const void *upage)
 {
-  struct vm_entry *vme = hash_entry(e, struct vm_entry, elem);
-  return hash_int((int)vme->vaddr);
+  struct vm_entry **slot = vm_slot (vm, upage, false);
+  return slot != NULL ? *slot : NULL;
 }
 
-static bool
-vm_less_func (const struct hash_elem *a, const struct hash_elem *b, void *aux)
+/* Gives back whatever backs VME: its frame if it is resident, and
+   its compressed copy or swap slot if it was evicted.  Eviction
+   clears is_loaded, so a page is never in two places at once. */
+static void
+vme_release (struct vm_entry *vme)
 {
-  struct vm_entry *vme_a = hash_entry(a, struct vm_entry, elem);
-  struct vm_entry *vme_b = hash_entry(b, struct vm_entry, elem);
-  return vme_a->vaddr < vme_b->vaddr;
+  if (vme->is_loaded) {
+    uint32_t *pd = thread_current ()->pagedir;
+    void *kaddr = pagedir_get_page (pd, vme->vaddr);
+    if (kaddr == zero_frame) {
+      /* Not ours to free. */
+      pagedir_clear_page (pd, vme->vaddr);
+    }
+    else if (kaddr != NULL) {
+      free_frame (kaddr);
+    }
+  }
+  zswap_invalidate (vme);
+  swap_clear (vme->swap_slot);
+  vme->swap_slot = 0;
+}
+
+/* Throws away the contents of VME's page, for MADV_DONTNEED.  The
+   next access reads the page afresh: from its file if it has one,
+   as zeros otherwise. */
+void
+vme_discard (struct vm_entry *vme)
+{
+  vme_release (vme);
+  vme->is_loaded = false;
+  if (vme->type == VM_ANON && vme->file != NULL) {
+    /* An executable page that went to swap: back to the file. */
+    vme->type = VM_BIN;
+  }
 }
 
 bool
-insert_vme (struct hash *vm, struct vm_entry *vme)
+insert_vme (struct vm_table *vm, struct vm_entry *vme)
 {
+  struct vm_entry **slot;
+  bool is_inserted = false;
   bool is_already_holded = lock_held_by_current_thread(&vm_lock);
   if (!is_already_holded) {
     lock_acquire (&vm_lock);
   }
-  bool is_inserted = (hash_insert(vm, &vme->elem) == NULL);
-  lock_release(&vm_lock);
+  slot = vm_slot (vm, vme->vaddr, true);
+  if (slot != NULL && *slot == NULL) {
+    *slot = vme;
+    is_inserted = true;
+  }
+  if (!is_already_holded) {
+    lock_release(&vm_lock);
+  }
   return is_inserted;
 }
 
 bool
-delete_vme (struct hash *vm, struct vm_entry *vme)
+delete_vme (struct vm_table *vm, struct vm_entry *vme)
 {
-  if (!hash_delete (vm, &vme->elem)){
+  struct vm_entry **slot = vm_slot (vm, vme->vaddr, false);
+  if (slot == NULL || *slot != vme) {
     return false;
   }
   bool is_already_holded = lock_held_by_current_thread(&vm_lock);
@@ -63,112 +168,346 @@ delete_vme (struct hash *vm, struct vm_entry *vme)
     lock_acquire (&vm_lock);
   }
 
-  if (vme->is_loaded) {
-    // palloc_free_page(vme->vaddr);
-    // pagedir_clear_page(pd, vme->vaddr);
-    free_frame(vme->vaddr);
-    swap_clear (vme->swap_slot);
-  }
-  // free_frame (vme->vaddr);
-  // swap_clear (vme->swap_slot);
+  *slot = NULL;
+  vme_release (vme);
   vme->type = NULL;
-  free (vme);
-  lock_release(&vm_lock);
+  slab_free (&vme_cache, vme);
+  if (!is_already_holded) {
+    lock_release(&vm_lock);
+  }
   return true;
 }
 
+/* Creates the entry for page UPAGE of AREA and adds it to VM.
+   Returns NULL if out of memory. */
+static struct vm_entry *
+vma_populate (struct vm_table *vm, struct vm_area *area, void *upage)
+{
+  size_t page_ofs = (uint8_t *) upage - (uint8_t *) area->start;
+  struct vm_entry *vme;
+
+  vme = slab_alloc (&vme_cache);
+  if (vme == NULL) {
+    return NULL;
+  }
+  memset(vme, 0, sizeof (struct vm_entry));
+  vme->type = area->type;
+  vme->vaddr = upage;
+  vme->writable = area->writable;
+  vme->is_loaded = false;
+  vme->offset = area->offset + page_ofs;
+  if (page_ofs < area->read_bytes) {
+    vme->read_bytes = area->read_bytes - page_ofs < PGSIZE
+                      ? area->read_bytes - page_ofs : PGSIZE;
+  }
+  vme->zero_bytes = PGSIZE - vme->read_bytes;
+  vme->swap_slot = 0;
+  vme->advice = area->advice;
+  vme->file = area->file;
+  if (!insert_vme (vm, vme)) {
+    slab_free (&vme_cache, vme);
+    return NULL;
+  }
+  return vme;
+}
+
+/* Returns the entry for the page containing VADDR in the current
+   thread, creating it if the page belongs to an area.  Returns NULL
+   if the page is not mapped. */
 struct vm_entry*
 find_vme (void *vaddr)
 {
-  struct hash *vm;
-  struct vm_entry vme;
-  struct hash_elem *elem;
+  struct vm_table *vm;
+  struct vm_entry *vme;
+  struct vm_area *area;
+  void *upage;
 
+  if (!is_user_vaddr (vaddr)) {
+    return NULL;
+  }
   vm = &thread_current ()->vm_table;
-  vme.vaddr = pg_round_down (vaddr);
-  elem = hash_find (vm, &vme.elem);
-  if (elem) {
-    return hash_entry(elem, struct vm_entry, elem);
+  upage = pg_round_down (vaddr);
+  vme = vm_lookup (vm, upage);
+  if (vme == NULL) {
+    area = vma_find (vm, upage);
+    if (area != NULL) {
+      vme = vma_populate (vm, area, upage);
+    }
+  }
+  return vme;
+}
+
+/* Like find_vme(), but only returns entries that already exist.
+   For callers that only care about pages that have been used. */
+struct vm_entry*
+peek_vme (void *vaddr)
+{
+  if (!is_user_vaddr (vaddr)) {
+    return NULL;
+  }
+  return vm_lookup (&thread_current ()->vm_table, pg_round_down (vaddr));
+}
+
+/* Adds an area of TYPE pages covering LENGTH bytes from START to
+   VM.  The first READ_BYTES bytes come from FILE at OFFSET and the
+   rest are zero-filled.  Returns NULL if out of memory. */
+struct vm_area *
+vma_create (struct vm_table *vm, uint8_t type, void *start, size_t length,
+            struct file *file, off_t offset, size_t read_bytes, bool writable)
+{
+  struct vm_area *area;
+
+  ASSERT (pg_ofs (start) == 0);
+
+  area = malloc (sizeof (struct vm_area));
+  if (area == NULL) {
+    return NULL;
+  }
+  area->type = type;
+  area->start = start;
+  area->end = (uint8_t *) start + ROUND_UP (length, PGSIZE);
+  area->file = file;
+  area->offset = offset;
+  area->read_bytes = read_bytes;
+  area->writable = writable;
+  area->advice = MADV_NORMAL;
+  list_push_back (&vm->areas, &area->elem);
+  return area;
+}
+
+/* Removes AREA from VM together with the entries created from it. */
+void
+vma_remove (struct vm_table *vm, struct vm_area *area)
+{
+  uint8_t *upage;
+
+  for (upage = area->start; upage < (uint8_t *) area->end; upage += PGSIZE) {
+    struct vm_entry *vme = vm_lookup (vm, upage);
+    if (vme != NULL) {
+      delete_vme (vm, vme);
+    }
+  }
+  list_remove (&area->elem);
+  free (area);
+}
+
+/* Moves the end of AREA to page boundary END, which must be past
+   its start.  When the area shrinks, the entries of the pages that
+   drop out are deleted. */
+void
+vma_resize (struct vm_table *vm, struct vm_area *area, void *end)
+{
+  uint8_t *upage;
+
+  ASSERT (pg_ofs (end) == 0);
+  ASSERT (end > area->start);
+
+  for (upage = end; upage < (uint8_t *) area->end; upage += PGSIZE) {
+    struct vm_entry *vme = vm_lookup (vm, upage);
+    if (vme != NULL) {
+      delete_vme (vm, vme);
+    }
+  }
+  area->end = end;
+}
+
+/* Returns the area of VM that contains UPAGE, or NULL.  If areas
+   overlap, the one added first wins. */
+struct vm_area *
+vma_find (struct vm_table *vm, const void *upage)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&vm->areas); e != list_end (&vm->areas); e = list_next (e)) {
+    struct vm_area *area = list_entry (e, struct vm_area, elem);
+    if (upage >= area->start && upage < area->end) {
+      return area;
+    }
   }
   return NULL;
 }
 
+/* Returns true if any page in [START, END) is mapped in VM, either
+   by an area or by an entry of its own. */
+bool
+vm_range_in_use (struct vm_table *vm, const void *start, const void *end)
+{
+  struct list_elem *e;
+  const uint8_t *upage;
+
+  for (e = list_begin (&vm->areas); e != list_end (&vm->areas); e = list_next (e)) {
+    struct vm_area *area = list_entry (e, struct vm_area, elem);
+    if (start < area->end && end > area->start) {
+      return true;
+    }
+  }
+  for (upage = start; upage < (const uint8_t *) end; upage += PGSIZE) {
+    if (vm_lookup (vm, upage) != NULL) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void
-vm_destroy (struct hash *vm)
+vm_destroy (struct vm_table *vm)
 {
+  size_t pde, pte;
+
   bool is_already_holded = lock_held_by_current_thread(&vm_lock);
   if (!is_already_holded) {
     lock_acquire (&vm_lock);
   }
-  hash_destroy (vm, vm_destroy_func);
-  lock_release(&vm_lock);
+  for (pde = 0; vm->dir != NULL && pde < VM_DIR_CNT; pde++) {
+    struct vm_entry **leaf = vm->dir[pde];
+    if (leaf == NULL) {
+      continue;
+    }
+    for (pte = 0; pte < VM_LEAF_CNT; pte++) {
+      struct vm_entry *vme = leaf[pte];
+      if (vme != NULL) {
+        vme_release (vme);
+        vme->type = NULL;
+        slab_free (&vme_cache, vme);
+      }
+    }
+    frame_free_table_page (leaf);
+  }
+  if (vm->dir != NULL) {
+    frame_free_table_page (vm->dir);
+    vm->dir = NULL;
+  }
+  while (!list_empty (&vm->areas)) {
+    free (list_entry (list_pop_front (&vm->areas), struct vm_area, elem));
+  }
+  if (!is_already_holded) {
+    lock_release(&vm_lock);
+  }
 }
 
-void
-vm_destroy_func (struct hash_elem *e, void *aux UNUSED)
+/* Creates a lazily zero-filled, writable VM_ANON page at UPAGE in
+   the current thread's table.  Returns NULL if out of memory or if
+   UPAGE is already in use. */
+struct vm_entry *
+vme_create_anon (void *upage)
 {
-  struct vm_entry *vme = hash_entry(e, struct vm_entry, elem);
-  uint32_t *pd = thread_current()->pagedir;
+  struct vm_entry *vme;
 
-  if (vme->is_loaded) {
-    // palloc_free_page(vme->vaddr);
-    // pagedir_clear_page(pd, vme->vaddr);
-    free_frame(vme->vaddr);
-    swap_clear (vme->swap_slot);
+  vme = slab_alloc (&vme_cache);
+  if (vme == NULL) {
+    return NULL;
   }
-  vme->type = NULL;
-  free(vme);
+  memset(vme, 0, sizeof (struct vm_entry));
+  vme->type = VM_ANON;
+  vme->vaddr = upage;
+  vme->writable = true;
+  vme->is_loaded = false;
+  vme->zero_bytes = PGSIZE;
+  vme->swap_slot = 0;
+  vme->file = NULL;
+  if (!insert_vme (&thread_current ()->vm_table, vme)) {
+    slab_free (&vme_cache, vme);
+    return NULL;
+  }
+  return vme;
 }
 
-bool load_file (void *kaddr, struct vm_entry *vme)
+/* fork() support: copies every area and page of PARENT that
+   mmap_fork() has not already set up into VM, the current thread's
+   table.  Resident pages are shared copy-on-write; pages of file
+   mappings are left for the child to fault in through its own
+   handle.  Returns false if out of memory. */
+bool
+vm_fork (struct vm_table *vm, struct thread *parent)
 {
-  if (file_read_at(vme->file, kaddr, vme->read_bytes, vme->offset) != (int)vme->read_bytes) {
-    return false;
+  struct vm_table *parent_vm = &parent->vm_table;
+  struct list_elem *e;
+  size_t pde, pte;
+
+  for (e = list_begin (&parent_vm->areas); e != list_end (&parent_vm->areas); e = list_next (e)) {
+    struct vm_area *parent_area = list_entry (e, struct vm_area, elem);
+    struct vm_area *area = vma_find (vm, parent_area->start);
+
+    if (area != NULL && area->start == parent_area->start) {
+      continue;
+    }
+    area = vma_create (vm, parent_area->type, parent_area->start,
+                       (uint8_t *) parent_area->end - (uint8_t *) parent_area->start,
+                       parent_area->file, parent_area->offset,
+                       parent_area->read_bytes, parent_area->writable);
+    if (area == NULL) {
+      return false;
+    }
+    area->advice = parent_area->advice;
+  }
+
+  if (parent_vm->dir == NULL) {
+    return true;
+  }
+  for (pde = 0; pde < VM_DIR_CNT; pde++) {
+    struct vm_entry **leaf = parent_vm->dir[pde];
+    if (leaf == NULL) {
+      continue;
+    }
+    for (pte = 0; pte < VM_LEAF_CNT; pte++) {
+      struct vm_entry *parent_vme = leaf[pte];
+      struct vm_area *area;
+      struct vm_entry *vme;
+
+      if (parent_vme == NULL || vm_lookup (vm, parent_vme->vaddr) != NULL) {
+        continue;
+      }
+      area = vma_find (vm, parent_vme->vaddr);
+      if (area != NULL && area->type == VM_FILE) {
+        continue;
+      }
+      vme = slab_alloc (&vme_cache);
+      if (vme == NULL) {
+        return false;
+      }
+      memcpy (vme, parent_vme, sizeof (struct vm_entry));
+      if (!frame_fork_page (parent, parent_vme, vme)) {
+        slab_free (&vme_cache, vme);
+        return false;
+      }
+      if (!insert_vme (vm, vme)) {
+        vme_release (vme);
+        slab_free (&vme_cache, vme);
+        return false;
+      }
+    }
   }
-  memset(kaddr + vme->read_bytes, 0, vme->zero_bytes);
   return true;
 }
 
-void
-check_valid_buffer (void* buffer, unsigned size, void* esp, bool to_write)
-{
-  // for (int i = 0; i < size; i++) {
-  //   struct vm_entry *vme = check_valid_address(buffer + i, esp);
-  //   if (vme == NULL) {
-  //     exit(-1);
-  //   }
-  //   if (to_write == true && vme->writable == false) {
-  //     exit(-1);
-  //   }
-  //   // if (to_write == false && vme->writable == true) {
-  //   //   exit(-1);
-  //   // }
-  // }
-  struct vm_entry *vme;
-	unsigned i;
-	char *check_buffer = (char *)buffer;
-	for(i=0; i<size; i++)
-	{
-		vme = check_valid_address((void *)check_buffer, esp);
-		if(vme != NULL){
-			if(to_write == true){
-				if(vme->writable == false){
-          exit(-1);
-        }
-			}
-		}
-		check_buffer++;
-	}
+/* Returns true if VME's page is known to be all zeros: never
+   written anonymous memory or the BSS part of an executable. */
+bool
+vme_is_zero_fill (const struct vm_entry *vme)
+{
+  switch (vme->type) {
+    case VM_BIN:
+      return vme->read_bytes == 0;
+    case VM_ANON:
+      return zswap_is_unbacked (vme);
+    default:
+      return false;
+  }
 }
 
-void
-check_valid_string (const void *str, void *esp)
+/* Returns true if VME's page may live in the page cache: pages of
+   mmap'd files, and read-only pages of executables. */
+bool
+vme_is_cacheable (const struct vm_entry *vme)
 {
-  char *check_str = (char *)str;
-	check_valid_address((void *)check_str, esp);
+  return vme->type == VM_FILE || (vme->type == VM_BIN && !vme->writable);
+}
 
-	while (*check_str != 0) {
-		check_str += 1;
-		check_valid_address(check_str, esp);
+bool load_file (void *kaddr, struct vm_entry *vme)
+{
+  if (file_read_at(vme->file, kaddr, vme->read_bytes, vme->offset) != (int)vme->read_bytes) {
+    return false;
   }
+  memset(kaddr + vme->read_bytes, 0, vme->zero_bytes);
+  return true;
 }
@@ -1,14 +1,31 @@
 #ifndef VM_PAGE_H
 #define VM_PAGE_H
 
-#include "threads/thread.h"
-#include "lib/kernel/hash.h"
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "filesys/file.h"
+#include "threads/slab.h"
+#include <syscall-nr.h>
 
 #define VM_BIN 0
 #define VM_FILE 1
 #define VM_ANON 2
 
+/* Default number of pages fault_around() may map after a faulting
+   file-backed page.  Overridden by the "-faultaround" kernel
+   option; 0 disables fault-around. */
+#define FAULT_AROUND_DEFAULT 8
+
+extern size_t fault_around_window;
+
+/* Cache that vm_entries are allocated from. */
+extern struct slab_cache vme_cache;
+
+struct thread;
+struct zswap_entry;
+
 struct vm_entry {
   uint8_t type;
   void *vaddr;
@@ -18,30 +35,67 @@ struct vm_entry {
   size_t read_bytes;
   size_t zero_bytes;
   size_t swap_slot;
+  struct zswap_entry *zswap;
+  uint8_t advice;               /* MADV_* hint from madvise(). */
+  bool pinned;                  /* Kept resident for a system call. */
   struct file* file;
-  struct list_elem mmap_elem;
-  struct hash_elem elem;
+};
+
+/* A range of pages described as a whole: an executable segment or
+   an mmap'd region.  vm_entries for its pages are only created when
+   they are first looked up, by find_vme(). */
+struct vm_area {
+  uint8_t type;                 /* Type of its pages: VM_BIN, VM_FILE
+                                   or VM_ANON. */
+  void *start;                  /* First page. */
+  void *end;                    /* End of the last page. */
+  struct file *file;            /* Backing file, or NULL. */
+  off_t offset;                 /* File offset of START. */
+  size_t read_bytes;            /* File bytes from START on; the rest
+                                   is zero-filled. */
+  bool writable;
+  uint8_t advice;               /* MADV_* hint for new pages. */
+  struct list_elem elem;        /* Element in vm_table's areas. */
+};
+
+/* A process's supplemental page table: vm_entries indexed by user
+   page, as a two-level radix tree, plus the areas that new entries
+   are created from.  See vm/page.c. */
+struct vm_table {
+  struct vm_entry ***dir;       /* Leaves by pd_no(), or NULL. */
+  struct list areas;            /* List of struct vm_area. */
 };
 
 struct mmap_file {
   int map_id;
   struct file *file;
   struct list_elem elem;
-  struct list vme_list;
+  struct vm_area *area;
 };
 
 /* Virtual Memory Table control functions */
-void vm_init (struct hash *vm_table);
-bool insert_vme (struct hash *vm, struct vm_entry *vme);
-bool delete_vme (struct hash *vm, struct vm_entry *vme);
+void page_init (void);
+void vm_init (struct vm_table *vm);
+bool insert_vme (struct vm_table *vm, struct vm_entry *vme);
+bool delete_vme (struct vm_table *vm, struct vm_entry *vme);
 struct vm_entry *find_vme (void *vaddr);
-void vm_destroy (struct hash *vm);
-void vm_destroy_func (struct hash_elem *e, void *aux UNUSED);
+struct vm_entry *peek_vme (void *vaddr);
+void vm_destroy (struct vm_table *vm);
+bool vm_fork (struct vm_table *vm, struct thread *parent);
+struct vm_entry *vme_create_anon (void *upage);
+void vme_discard (struct vm_entry *vme);
 
+struct vm_area *vma_create (struct vm_table *vm, uint8_t type, void *start,
+                            size_t length, struct file *file, off_t offset,
+                            size_t read_bytes, bool writable);
+void vma_remove (struct vm_table *vm, struct vm_area *area);
+void vma_resize (struct vm_table *vm, struct vm_area *area, void *end);
+struct vm_area *vma_find (struct vm_table *vm, const void *upage);
+bool vm_range_in_use (struct vm_table *vm, const void *start, const void *end);
 
-bool load_file (void *kaddr, struct vm_entry *vme);
 
-void check_valid_buffer (void* buffer, unsigned size, void* esp, bool to_write);
-void check_valid_string (const void *str, void *esp);
+bool load_file (void *kaddr, struct vm_entry *vme);
+bool vme_is_zero_fill (const struct vm_entry *vme);
+bool vme_is_cacheable (const struct vm_entry *vme);
 
 #endif /* vm/page.h */
\ No newline at end of file
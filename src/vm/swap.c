@@ -4,10 +4,14 @@
 #include "devices/block.h"
 #include "threads/vaddr.h"
 #include "threads/interrupt.h"
+#include "threads/palloc.h"
 
+/* Protects swap_bitmap.  The block layer serializes access to the
+   swap device, so filesys_lock is not taken here: eviction swaps
+   with ft_lock held, which must nest inside filesys_lock. */
 struct lock swap_lock;
 struct bitmap *swap_bitmap;
-extern struct lock filesys_lock;
+size_t swap_readahead_window = SWAP_READAHEAD_DEFAULT;
 
 void
 swap_init (size_t size)
@@ -23,7 +27,6 @@ swap_in (size_t used_index, void *kaddr)
   swap_block = block_get_role (BLOCK_SWAP);
   used_index--;
 
-  lock_acquire (&filesys_lock);
   lock_acquire (&swap_lock);
   used_index = used_index * 8;
   for (int i = 0; i < 8; i++){
@@ -32,9 +35,10 @@ swap_in (size_t used_index, void *kaddr)
   used_index = used_index / 8;
   bitmap_set_multiple (swap_bitmap, used_index, 1, false);
   lock_release (&swap_lock);
-  lock_release (&filesys_lock);
 }
 
+/* Writes the page at KADDR to a free swap slot and returns the
+   slot.  Returns 0 if the swap device is full. */
 size_t
 swap_out (void *kaddr)
 {
@@ -42,16 +46,52 @@ swap_out (void *kaddr)
   size_t swap_index;
   swap_block = block_get_role (BLOCK_SWAP);
 
-  lock_acquire (&filesys_lock);
   lock_acquire (&swap_lock);
   swap_index = bitmap_scan_and_flip (swap_bitmap, 0, 1, false);
+  if (swap_index == BITMAP_ERROR) {
+    lock_release (&swap_lock);
+    return 0;
+  }
   swap_index = swap_index * 8;
   for (int i = 0; i < 8; i++){
     block_write (swap_block, swap_index + i, kaddr + BLOCK_SECTOR_SIZE * i);
   }
   swap_index = swap_index / 8;
   lock_release (&swap_lock);
-  lock_release (&filesys_lock);
+
+  return swap_index + 1;
+}
+
+/* Copies the page in swap slot USED_INDEX to a fresh slot, for a
+   forked child, and returns the new slot.  Returns 0 if there is
+   no free slot or no memory for the copy. */
+size_t
+swap_dup (size_t used_index)
+{
+  struct block *swap_block;
+  size_t swap_index;
+  void *bounce;
+
+  swap_block = block_get_role (BLOCK_SWAP);
+  bounce = palloc_get_page (0);
+  if (bounce == NULL) {
+    return 0;
+  }
+  used_index--;
+
+  lock_acquire (&swap_lock);
+  swap_index = bitmap_scan_and_flip (swap_bitmap, 0, 1, false);
+  if (swap_index == BITMAP_ERROR) {
+    lock_release (&swap_lock);
+    palloc_free_page (bounce);
+    return 0;
+  }
+  for (int i = 0; i < 8; i++){
+    block_read (swap_block, used_index * 8 + i, bounce + BLOCK_SECTOR_SIZE * i);
+    block_write (swap_block, swap_index * 8 + i, bounce + BLOCK_SECTOR_SIZE * i);
+  }
+  lock_release (&swap_lock);
+  palloc_free_page (bounce);
 
   return swap_index + 1;
 }
@@ -3,9 +3,16 @@
 
 #include <stddef.h>
 
+/* Default number of pages swap_in() clustering may bring in after
+   the faulting page.  Overridden by the "-swapra" kernel option. */
+#define SWAP_READAHEAD_DEFAULT 8
+
+extern size_t swap_readahead_window;
+
 void swap_init (size_t size);
 void swap_in (size_t used_index, void *kaddr);
 size_t swap_out (void *kaddr);
+size_t swap_dup (size_t used_index);
 void swap_clear (size_t used_index);
 
 #endif /* vm/swap.h */
\ No newline at end of file
@@ -0,0 +1,375 @@
+#include "vm/zswap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/swap.h"
+
+/* Compressed swap tier.
+
+   Evicted anonymous pages are compressed into an arena of kernel
+   pages instead of going straight to the swap device.  The arena
+   is carved into ZSWAP_CHUNK_SIZE byte chunks; a compressed page
+   occupies a run of consecutive chunks.  When the arena is full,
+   the oldest entries are decompressed and written to the swap
+   device to make room.  Pages that do not shrink below
+   ZSWAP_MAX_SIZE are not worth keeping and go to disk directly. */
+
+#define ZSWAP_ARENA_PAGES 32
+#define ZSWAP_CHUNK_SIZE 64
+#define ZSWAP_CHUNK_CNT (ZSWAP_ARENA_PAGES * PGSIZE / ZSWAP_CHUNK_SIZE)
+#define ZSWAP_MAX_SIZE (PGSIZE * 3 / 4)
+
+/* A compressed page held in the arena. */
+struct zswap_entry {
+  struct vm_entry *vme;               /* Page this data belongs to. */
+  size_t chunk;                       /* First arena chunk. */
+  size_t length;                      /* Compressed size in bytes. */
+  struct list_elem elem;              /* Element in zswap_list. */
+};
+
+static uint8_t *zswap_arena;
+static struct bitmap *zswap_chunks;
+static struct list zswap_list;        /* Entries, oldest first. */
+static struct lock zswap_lock;
+
+/* Scratch pages: compressor output and writeback bounce buffer. */
+static uint8_t *zswap_cbuf;
+static uint8_t *zswap_wbuf;
+
+static size_t lz_compress (const uint8_t *src, size_t src_len,
+                           uint8_t *dst, size_t dst_max);
+static bool lz_decompress (const uint8_t *src, size_t src_len,
+                           uint8_t *dst, size_t dst_len);
+static bool zswap_writeback_oldest (void);
+static void zswap_free_entry (struct zswap_entry *entry);
+
+void
+zswap_init (void)
+{
+  lock_init (&zswap_lock);
+  list_init (&zswap_list);
+  zswap_arena = palloc_get_multiple (0, ZSWAP_ARENA_PAGES);
+  zswap_cbuf = palloc_get_page (0);
+  zswap_wbuf = palloc_get_page (0);
+  zswap_chunks = bitmap_create (ZSWAP_CHUNK_CNT);
+  if (zswap_arena == NULL || zswap_cbuf == NULL || zswap_wbuf == NULL
+      || zswap_chunks == NULL) {
+    PANIC ("zswap_init: out of kernel memory");
+  }
+}
+
+/* Compresses the page at KADDR into the arena on behalf of VME.
+   Returns false if the page does not compress well or the arena
+   cannot make room, in which case the caller swaps it out. */
+bool
+zswap_store (struct vm_entry *vme, const void *kaddr)
+{
+  struct zswap_entry *entry;
+  size_t length, chunk_cnt, chunk;
+
+  entry = malloc (sizeof (struct zswap_entry));
+  if (entry == NULL) {
+    return false;
+  }
+
+  lock_acquire (&zswap_lock);
+  length = lz_compress (kaddr, PGSIZE, zswap_cbuf, ZSWAP_MAX_SIZE);
+  if (length == 0) {
+    lock_release (&zswap_lock);
+    free (entry);
+    return false;
+  }
+
+  chunk_cnt = DIV_ROUND_UP (length, ZSWAP_CHUNK_SIZE);
+  while ((chunk = bitmap_scan_and_flip (zswap_chunks, 0, chunk_cnt, false))
+         == BITMAP_ERROR) {
+    if (list_empty (&zswap_list) || !zswap_writeback_oldest ()) {
+      lock_release (&zswap_lock);
+      free (entry);
+      return false;
+    }
+  }
+
+  memcpy (zswap_arena + chunk * ZSWAP_CHUNK_SIZE, zswap_cbuf, length);
+  entry->vme = vme;
+  entry->chunk = chunk;
+  entry->length = length;
+  list_push_back (&zswap_list, &entry->elem);
+  vme->zswap = entry;
+  lock_release (&zswap_lock);
+  return true;
+}
+
+/* Decompresses VME's page into KADDR and drops it from the arena.
+   Returns false if VME has no compressed copy, e.g. because it was
+   written back to the swap device in the meantime. */
+bool
+zswap_load (struct vm_entry *vme, void *kaddr)
+{
+  struct zswap_entry *entry;
+
+  lock_acquire (&zswap_lock);
+  entry = vme->zswap;
+  if (entry == NULL) {
+    lock_release (&zswap_lock);
+    return false;
+  }
+  if (!lz_decompress (zswap_arena + entry->chunk * ZSWAP_CHUNK_SIZE,
+                      entry->length, kaddr, PGSIZE)) {
+    PANIC ("zswap_load: corrupted entry");
+  }
+  zswap_free_entry (entry);
+  lock_release (&zswap_lock);
+  return true;
+}
+
+/* Gives DST, a forked child's page, its own copy of SRC's
+   compressed page.  If the arena is full the copy goes to the swap
+   device instead.  Returns false if SRC has no compressed copy.
+   Otherwise returns true, leaving DST with neither a copy nor a
+   swap slot if the swap device is full too. */
+bool
+zswap_dup (struct vm_entry *src, struct vm_entry *dst)
+{
+  struct zswap_entry *entry, *copy;
+  size_t chunk;
+
+  copy = malloc (sizeof (struct zswap_entry));
+  lock_acquire (&zswap_lock);
+  entry = src->zswap;
+  if (entry == NULL) {
+    lock_release (&zswap_lock);
+    free (copy);
+    return false;
+  }
+
+  chunk = BITMAP_ERROR;
+  if (copy != NULL) {
+    chunk = bitmap_scan_and_flip (zswap_chunks, 0,
+                                  DIV_ROUND_UP (entry->length, ZSWAP_CHUNK_SIZE),
+                                  false);
+  }
+  if (chunk == BITMAP_ERROR) {
+    if (!lz_decompress (zswap_arena + entry->chunk * ZSWAP_CHUNK_SIZE,
+                        entry->length, zswap_wbuf, PGSIZE)) {
+      PANIC ("zswap_dup: corrupted entry");
+    }
+    dst->swap_slot = swap_out (zswap_wbuf);
+    dst->zswap = NULL;
+    lock_release (&zswap_lock);
+    free (copy);
+    return true;
+  }
+
+  memcpy (zswap_arena + chunk * ZSWAP_CHUNK_SIZE,
+          zswap_arena + entry->chunk * ZSWAP_CHUNK_SIZE, entry->length);
+  copy->vme = dst;
+  copy->chunk = chunk;
+  copy->length = entry->length;
+  list_push_back (&zswap_list, &copy->elem);
+  dst->zswap = copy;
+  lock_release (&zswap_lock);
+  return true;
+}
+
+/* Returns true if VME's page has neither a compressed copy nor a
+   swap slot.  The two are read under zswap_lock, which
+   zswap_writeback_oldest() holds while it moves a page from the
+   arena to a swap slot. */
+bool
+zswap_is_unbacked (const struct vm_entry *vme)
+{
+  bool unbacked;
+
+  lock_acquire (&zswap_lock);
+  unbacked = vme->swap_slot == 0 && vme->zswap == NULL;
+  lock_release (&zswap_lock);
+  return unbacked;
+}
+
+/* Discards VME's compressed copy, if any. */
+void
+zswap_invalidate (struct vm_entry *vme)
+{
+  lock_acquire (&zswap_lock);
+  if (vme->zswap != NULL) {
+    zswap_free_entry (vme->zswap);
+  }
+  lock_release (&zswap_lock);
+}
+
+/* Moves the oldest compressed page out to the swap device.
+   Returns false, keeping the page, if the swap device is full.
+   zswap_lock must be held. */
+static bool
+zswap_writeback_oldest (void)
+{
+  struct zswap_entry *entry;
+  size_t slot;
+
+  ASSERT (lock_held_by_current_thread (&zswap_lock));
+
+  entry = list_entry (list_front (&zswap_list), struct zswap_entry, elem);
+  if (!lz_decompress (zswap_arena + entry->chunk * ZSWAP_CHUNK_SIZE,
+                      entry->length, zswap_wbuf, PGSIZE)) {
+    PANIC ("zswap_writeback_oldest: corrupted entry");
+  }
+  slot = swap_out (zswap_wbuf);
+  if (slot == 0) {
+    return false;
+  }
+  entry->vme->swap_slot = slot;
+  zswap_free_entry (entry);
+  return true;
+}
+
+/* Returns ENTRY's chunks to the arena and detaches it from its
+   vm_entry.  zswap_lock must be held. */
+static void
+zswap_free_entry (struct zswap_entry *entry)
+{
+  bitmap_set_multiple (zswap_chunks, entry->chunk,
+                       DIV_ROUND_UP (entry->length, ZSWAP_CHUNK_SIZE), false);
+  list_remove (&entry->elem);
+  entry->vme->zswap = NULL;
+  free (entry);
+}
+
+/* LZ77-style compressor.
+
+   The output is a sequence of tokens, each starting with a control
+   byte C:
+
+        C < 0x80:  C + 1 literal bytes follow.
+        C >= 0x80: copy (C & 0x7f) + LZ_MIN_MATCH bytes starting
+                   D bytes back in the output, where D is the
+                   following 16-bit little-endian value.
+
+   Matches are found through a hash of the next three bytes that
+   remembers the most recent position with that hash. */
+
+#define LZ_MIN_MATCH 3
+#define LZ_MAX_MATCH (0x7f + LZ_MIN_MATCH)
+#define LZ_MAX_LITERALS 0x80
+#define LZ_HASH_BITS 12
+#define LZ_NO_POS 0xffff
+
+static uint16_t lz_table[1 << LZ_HASH_BITS];
+
+static inline unsigned
+lz_hash (const uint8_t *p)
+{
+  uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Appends literals SRC[START, END) to DST at *OUT.  Returns false
+   if that would exceed DST_MAX bytes. */
+static bool
+lz_emit_literals (const uint8_t *src, size_t start, size_t end,
+                  uint8_t *dst, size_t *out, size_t dst_max)
+{
+  while (start < end) {
+    size_t n = end - start < LZ_MAX_LITERALS ? end - start : LZ_MAX_LITERALS;
+    if (*out + 1 + n > dst_max) {
+      return false;
+    }
+    dst[(*out)++] = n - 1;
+    memcpy (dst + *out, src + start, n);
+    *out += n;
+    start += n;
+  }
+  return true;
+}
+
+/* Compresses SRC_LEN bytes at SRC into DST.  Returns the compressed
+   length, or 0 if it would not fit in DST_MAX bytes.  Uses lz_table,
+   so callers must serialize. */
+static size_t
+lz_compress (const uint8_t *src, size_t src_len,
+             uint8_t *dst, size_t dst_max)
+{
+  size_t ip = 0, lit_start = 0, out = 0;
+
+  ASSERT (src_len <= LZ_NO_POS);
+  memset (lz_table, 0xff, sizeof lz_table);
+
+  while (ip + LZ_MIN_MATCH <= src_len) {
+    unsigned h = lz_hash (src + ip);
+    size_t ref = lz_table[h];
+    lz_table[h] = ip;
+
+    if (ref != LZ_NO_POS && memcmp (src + ref, src + ip, LZ_MIN_MATCH) == 0) {
+      size_t len = LZ_MIN_MATCH;
+      size_t dist = ip - ref;
+
+      while (ip + len < src_len && len < LZ_MAX_MATCH
+             && src[ref + len] == src[ip + len]) {
+        len++;
+      }
+      if (!lz_emit_literals (src, lit_start, ip, dst, &out, dst_max)
+          || out + 3 > dst_max) {
+        return 0;
+      }
+      dst[out++] = 0x80 | (len - LZ_MIN_MATCH);
+      dst[out++] = dist & 0xff;
+      dst[out++] = dist >> 8;
+      ip += len;
+      lit_start = ip;
+    }
+    else {
+      ip++;
+    }
+  }
+
+  if (!lz_emit_literals (src, lit_start, src_len, dst, &out, dst_max)) {
+    return 0;
+  }
+  return out;
+}
+
+/* Decompresses SRC_LEN bytes at SRC into exactly DST_LEN bytes at
+   DST.  Returns false if the input is malformed. */
+static bool
+lz_decompress (const uint8_t *src, size_t src_len,
+               uint8_t *dst, size_t dst_len)
+{
+  size_t ip = 0, op = 0;
+
+  while (ip < src_len) {
+    uint8_t c = src[ip++];
+    if (c < 0x80) {
+      size_t n = c + 1;
+      if (ip + n > src_len || op + n > dst_len) {
+        return false;
+      }
+      memcpy (dst + op, src + ip, n);
+      ip += n;
+      op += n;
+    }
+    else {
+      size_t len = (c & 0x7f) + LZ_MIN_MATCH;
+      size_t dist;
+      if (ip + 2 > src_len) {
+        return false;
+      }
+      dist = src[ip] | (src[ip + 1] << 8);
+      ip += 2;
+      if (dist == 0 || dist > op || op + len > dst_len) {
+        return false;
+      }
+      /* Byte by byte: source and destination may overlap. */
+      while (len-- > 0) {
+        dst[op] = dst[op - dist];
+        op++;
+      }
+    }
+  }
+  return op == dst_len;
+}
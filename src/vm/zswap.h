@@ -0,0 +1,14 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+
+#include <stdbool.h>
+#include "vm/page.h"
+
+void zswap_init (void);
+bool zswap_store (struct vm_entry *vme, const void *kaddr);
+bool zswap_load (struct vm_entry *vme, void *kaddr);
+bool zswap_dup (struct vm_entry *src, struct vm_entry *dst);
+bool zswap_is_unbacked (const struct vm_entry *vme);
+void zswap_invalidate (struct vm_entry *vme);
+
+#endif /* vm/zswap.h */